@@ -17,6 +17,7 @@
 #include "base/task/post_task.h"
 #include "brave/browser/brave_browser_main_extra_parts.h"
 #include "brave/browser/brave_browser_process_impl.h"
+#include "brave/browser/cosmetic_filters/cosmetic_resources_cache_factory.h"
 #include "brave/browser/net/brave_proxying_url_loader_factory.h"
 #include "brave/browser/net/brave_proxying_web_socket.h"
 #include "brave/common/pref_names.h"
@@ -225,7 +226,9 @@ void BindCosmeticFiltersResources(
 
   mojo::MakeSelfOwnedReceiver(
       std::make_unique<cosmetic_filters::CosmeticFiltersResources>(
-          settings_map, g_brave_browser_process->ad_block_service()),
+          settings_map, g_brave_browser_process->ad_block_service(),
+          cosmetic_filters::CosmeticResourcesCacheFactory::GetForBrowserContext(
+              profile)),
       std::move(receiver));
 }
 
@@ -0,0 +1,49 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/brave_shields/shields_decision_cache_factory.h"
+#include "brave/components/brave_shields/browser/shields_decision_cache.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/browser/profiles/incognito_helpers.h"
+#include "chrome/browser/profiles/profile.h"
+#include "components/keyed_service/content/browser_context_dependency_manager.h"
+
+namespace brave_shields {
+
+// static
+ShieldsDecisionCache* ShieldsDecisionCacheFactory::GetForBrowserContext(
+    content::BrowserContext* context) {
+  return static_cast<ShieldsDecisionCache*>(
+      GetInstance()->GetServiceForBrowserContext(context,
+                                                 /*create_service=*/true));
+}
+
+// static
+ShieldsDecisionCacheFactory* ShieldsDecisionCacheFactory::GetInstance() {
+  return base::Singleton<ShieldsDecisionCacheFactory>::get();
+}
+
+ShieldsDecisionCacheFactory::ShieldsDecisionCacheFactory()
+    : BrowserContextKeyedServiceFactory(
+          "ShieldsDecisionCache",
+          BrowserContextDependencyManager::GetInstance()) {
+  DependsOn(HostContentSettingsMapFactory::GetInstance());
+}
+
+ShieldsDecisionCacheFactory::~ShieldsDecisionCacheFactory() {}
+
+KeyedService* ShieldsDecisionCacheFactory::BuildServiceInstanceFor(
+    content::BrowserContext* context) const {
+  return new ShieldsDecisionCache(HostContentSettingsMapFactory::GetForProfile(
+      Profile::FromBrowserContext(context)));
+}
+
+content::BrowserContext* ShieldsDecisionCacheFactory::GetBrowserContextToUse(
+    content::BrowserContext* context) const {
+  // Incognito profiles have their own content settings.
+  return chrome::GetBrowserContextOwnInstanceInIncognito(context);
+}
+
+}  // namespace brave_shields
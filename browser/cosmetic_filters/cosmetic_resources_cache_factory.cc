@@ -0,0 +1,45 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/cosmetic_filters/cosmetic_resources_cache_factory.h"
+#include "brave/components/cosmetic_filters/browser/cosmetic_resources_cache.h"
+#include "chrome/browser/profiles/incognito_helpers.h"
+#include "components/keyed_service/content/browser_context_dependency_manager.h"
+
+namespace cosmetic_filters {
+
+// static
+CosmeticResourcesCache* CosmeticResourcesCacheFactory::GetForBrowserContext(
+    content::BrowserContext* context) {
+  return static_cast<CosmeticResourcesCache*>(
+      GetInstance()->GetServiceForBrowserContext(context,
+                                                 /*create_service=*/true));
+}
+
+// static
+CosmeticResourcesCacheFactory* CosmeticResourcesCacheFactory::GetInstance() {
+  return base::Singleton<CosmeticResourcesCacheFactory>::get();
+}
+
+CosmeticResourcesCacheFactory::CosmeticResourcesCacheFactory()
+    : BrowserContextKeyedServiceFactory(
+          "CosmeticResourcesCache",
+          BrowserContextDependencyManager::GetInstance()) {}
+
+CosmeticResourcesCacheFactory::~CosmeticResourcesCacheFactory() {}
+
+KeyedService* CosmeticResourcesCacheFactory::BuildServiceInstanceFor(
+    content::BrowserContext* context) const {
+  return new CosmeticResourcesCache();
+}
+
+content::BrowserContext* CosmeticResourcesCacheFactory::GetBrowserContextToUse(
+    content::BrowserContext* context) const {
+  // The URLs a private window visited must not be observable from, or
+  // outlive, the private session.
+  return chrome::GetBrowserContextOwnInstanceInIncognito(context);
+}
+
+}  // namespace cosmetic_filters
@@ -0,0 +1,40 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_COSMETIC_FILTERS_COSMETIC_RESOURCES_CACHE_FACTORY_H_
+#define BRAVE_BROWSER_COSMETIC_FILTERS_COSMETIC_RESOURCES_CACHE_FACTORY_H_
+
+#include "base/memory/singleton.h"
+#include "components/keyed_service/content/browser_context_keyed_service_factory.h"
+
+namespace cosmetic_filters {
+
+class CosmeticResourcesCache;
+
+class CosmeticResourcesCacheFactory : public BrowserContextKeyedServiceFactory {
+ public:
+  static CosmeticResourcesCache* GetForBrowserContext(
+      content::BrowserContext* context);
+
+  static CosmeticResourcesCacheFactory* GetInstance();
+
+ private:
+  friend struct base::DefaultSingletonTraits<CosmeticResourcesCacheFactory>;
+
+  CosmeticResourcesCacheFactory();
+  ~CosmeticResourcesCacheFactory() override;
+
+  // BrowserContextKeyedServiceFactory:
+  KeyedService* BuildServiceInstanceFor(
+      content::BrowserContext* context) const override;
+  content::BrowserContext* GetBrowserContextToUse(
+      content::BrowserContext* context) const override;
+
+  DISALLOW_COPY_AND_ASSIGN(CosmeticResourcesCacheFactory);
+};
+
+}  // namespace cosmetic_filters
+
+#endif  // BRAVE_BROWSER_COSMETIC_FILTERS_COSMETIC_RESOURCES_CACHE_FACTORY_H_
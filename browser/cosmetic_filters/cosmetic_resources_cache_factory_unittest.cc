@@ -0,0 +1,57 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/cosmetic_filters/cosmetic_resources_cache_factory.h"
+#include "brave/components/cosmetic_filters/browser/cosmetic_resources_cache.h"
+#include "chrome/test/base/testing_browser_process.h"
+#include "chrome/test/base/testing_profile.h"
+#include "chrome/test/base/testing_profile_manager.h"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cosmetic_filters {
+
+class CosmeticResourcesCacheFactoryTest : public testing::Test {
+ public:
+  CosmeticResourcesCacheFactoryTest()
+      : manager_(TestingBrowserProcess::GetGlobal()) {}
+  ~CosmeticResourcesCacheFactoryTest() override {}
+
+ protected:
+  void SetUp() override { ASSERT_TRUE(manager_.SetUp()); }
+
+  TestingProfileManager* manager() { return &manager_; }
+
+ private:
+  content::BrowserTaskEnvironment task_environment_;
+  TestingProfileManager manager_;
+};
+
+TEST_F(CosmeticResourcesCacheFactoryTest, NotSharedAcrossProfiles) {
+  Profile* profile = manager()->CreateTestingProfile("Test 1");
+  Profile* other_profile = manager()->CreateTestingProfile("Test 2");
+  Profile* otr_profile = profile->GetPrimaryOTRProfile();
+
+  CosmeticResourcesCache* cache =
+      CosmeticResourcesCacheFactory::GetForBrowserContext(profile);
+  CosmeticResourcesCache* other_cache =
+      CosmeticResourcesCacheFactory::GetForBrowserContext(other_profile);
+  CosmeticResourcesCache* otr_cache =
+      CosmeticResourcesCacheFactory::GetForBrowserContext(otr_profile);
+  ASSERT_TRUE(cache);
+  ASSERT_TRUE(other_cache);
+  ASSERT_TRUE(otr_cache);
+  EXPECT_NE(cache, other_cache);
+  EXPECT_NE(cache, otr_cache);
+
+  // What a private window visited is not visible from the regular profile.
+  mojom::CosmeticResourcesPtr resources;
+  otr_cache->Put("https://a.com/", 1, mojom::CosmeticResources::New());
+  EXPECT_FALSE(cache->Get("https://a.com/", 1, &resources));
+  EXPECT_FALSE(other_cache->Get("https://a.com/", 1, &resources));
+  EXPECT_TRUE(otr_cache->Get("https://a.com/", 1, &resources));
+}
+
+}  // namespace cosmetic_filters
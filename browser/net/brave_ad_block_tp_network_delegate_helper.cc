@@ -11,14 +11,21 @@
 #include <vector>
 
 #include "base/base64url.h"
+#include "base/feature_list.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "brave/browser/brave_browser_process_impl.h"
+#include "brave/browser/brave_shields/shields_decision_cache_factory.h"
+#include "brave/browser/net/brave_request_batcher.h"
 #include "brave/browser/net/url_context.h"
 #include "brave/common/network_constants.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
+#include "brave/components/brave_shields/browser/shields_decision_cache.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
+#include "brave/components/brave_shields/common/features.h"
 #include "brave/grit/brave_generated_resources.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_thread.h"
@@ -54,83 +61,184 @@ content::WebContents* GetWebContents(int render_process_id,
 
 }  // namespace
 
-void ShouldBlockAdOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx,
-                               base::Optional<std::string> canonical_name) {
-  bool did_match_rule = false;
-  bool did_match_exception = false;
-  bool did_match_important = false;
-  if (!ctx->initiator_url.is_valid()) {
-    return;
-  }
-  std::string source_host = ctx->initiator_url.host();
+namespace {
 
-  g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-      ctx->request_url, ctx->resource_type, source_host, &did_match_rule,
-      &did_match_exception, &did_match_important, &ctx->mock_data_url);
-  if (did_match_important) {
-    ctx->blocked_by = kAdBlocked;
-    return;
-  }
+bool ShouldCheckCanonicalName(const BraveRequestInfo& ctx) {
+  const auto& canonical_name = ctx.adblock_canonical_name;
+  return canonical_name.has_value() && !canonical_name->empty() &&
+         ctx.request_url.host() != *canonical_name;
+}
 
-  if (canonical_name.has_value() &&
-      ctx->request_url.host() != *canonical_name && *canonical_name != "") {
-    GURL::Replacements replacements = GURL::Replacements();
-    replacements.SetHost(
-        canonical_name->c_str(),
-        url::Component(0, static_cast<int>(canonical_name->length())));
-    const GURL canonical_url = ctx->request_url.ReplaceComponents(replacements);
+GURL GetCanonicalURL(const GURL& request_url,
+                     const std::string& canonical_name) {
+  GURL::Replacements replacements = GURL::Replacements();
+  replacements.SetHost(
+      canonical_name.c_str(),
+      url::Component(0, static_cast<int>(canonical_name.length())));
+  return request_url.ReplaceComponents(replacements);
+}
 
-    g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-        ctx->request_url, ctx->resource_type, source_host, &did_match_rule,
-        &did_match_exception, &did_match_important, &ctx->mock_data_url);
+bool IsBlocked(const brave_shields::AdBlockMatchRequest& request) {
+  return request.did_match_important ||
+         (request.did_match_rule && !request.did_match_exception);
+}
+
+void ShouldBlockAdsOffUI(const BraveRequestBatch& batch) {
+  // First pass: match every request URL against all engines at once.
+  brave_shields::AdBlockMatchRequests requests;
+  std::vector<BraveRequestInfo*> matched;
+  requests.reserve(batch.size());
+  matched.reserve(batch.size());
+  for (const auto& ctx : batch) {
+    if (!ctx->initiator_url.is_valid())
+      continue;
+    requests.emplace_back(ctx->request_url, ctx->resource_type,
+                          ctx->initiator_url.host());
+    matched.push_back(ctx.get());
+  }
+  if (requests.empty())
+    return;
+
+  g_brave_browser_process->ad_block_service()->ShouldStartRequests(&requests);
+
+  // Second pass: requests that weren't blocked by an important rule are
+  // checked again using their uncloaked CNAME, keeping the results of the
+  // first pass.
+  brave_shields::AdBlockMatchRequests cname_requests;
+  std::vector<size_t> cname_indices;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    if (requests[i].did_match_important ||
+        !ShouldCheckCanonicalName(*matched[i])) {
+      continue;
+    }
+    brave_shields::AdBlockMatchRequest cname_request = requests[i];
+    cname_request.url =
+        GetCanonicalURL(requests[i].url, *matched[i]->adblock_canonical_name);
+    cname_requests.push_back(std::move(cname_request));
+    cname_indices.push_back(i);
+  }
+  if (!cname_requests.empty()) {
+    g_brave_browser_process->ad_block_service()->ShouldStartRequests(
+        &cname_requests);
+    for (size_t i = 0; i < cname_requests.size(); ++i) {
+      auto& request = requests[cname_indices[i]];
+      request.did_match_rule = cname_requests[i].did_match_rule;
+      request.did_match_exception = cname_requests[i].did_match_exception;
+      request.did_match_important = cname_requests[i].did_match_important;
+      request.mock_data_url = std::move(cname_requests[i].mock_data_url);
+    }
   }
 
-  if (did_match_important || (did_match_rule && !did_match_exception)) {
-    ctx->blocked_by = kAdBlocked;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    BraveRequestInfo* ctx = matched[i];
+    ctx->mock_data_url = std::move(requests[i].mock_data_url);
+    if (IsBlocked(requests[i]))
+      ctx->blocked_by = kAdBlocked;
   }
 }
 
-void OnShouldBlockAdResult(const ResponseCallback& next_callback,
-                           std::shared_ptr<BraveRequestInfo> ctx) {
+std::vector<int> MatchAdBlockBatch(const BraveRequestBatch& batch) {
+  ShouldBlockAdsOffUI(batch);
+  return std::vector<int>(batch.size(), net::OK);
+}
+
+brave_shields::ShieldsDecisionCache* GetDecisionCache(
+    const BraveRequestInfo& ctx) {
+  return brave_shields::ShieldsDecisionCacheFactory::GetForBrowserContext(
+      ctx.browser_context);
+}
+
+void OnAdBlockMatched(const BraveRequestInfo& ctx) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  if (ctx->blocked_by == kAdBlocked) {
+  if (ctx.cache_adblock_verdict && ctx.initiator_url.is_valid()) {
+    brave_shields::AdBlockVerdict verdict;
+    verdict.blocked = ctx.blocked_by == kAdBlocked;
+    verdict.mock_data_url = ctx.mock_data_url;
+    GetDecisionCache(ctx)->SetAdBlockVerdict(
+        ctx.request_url, ctx.resource_type, ctx.initiator_url.host(),
+        ctx.adblock_engine_version, verdict);
+  }
+  if (ctx.blocked_by == kAdBlocked) {
     brave_shields::DispatchBlockedEvent(
-        ctx->request_url, ctx->render_frame_id, ctx->render_process_id,
-        ctx->frame_tree_node_id, brave_shields::kAds);
+        ctx.request_url, ctx.render_frame_id, ctx.render_process_id,
+        ctx.frame_tree_node_id, brave_shields::kAds);
   }
+}
+
+void OnShouldBlockAdsResult(const ResponseCallback& next_callback,
+                            std::shared_ptr<BraveRequestInfo> ctx,
+                            int rv) {
+  OnAdBlockMatched(*ctx);
   next_callback.Run();
 }
 
-void ShouldBlockAdWithOptionalCname(
-    scoped_refptr<base::SequencedTaskRunner> task_runner,
-    const ResponseCallback& next_callback,
-    std::shared_ptr<BraveRequestInfo> ctx,
-    const base::Optional<std::string> cname) {
+// Batches the adblock checks of the requests that are matched on their own,
+// rather than as part of the off-UI request chain.
+BraveRequestBatcher* GetAdBlockRequestBatcher() {
+  static base::NoDestructor<BraveRequestBatcher> batcher(
+      base::BindRepeating(&MatchAdBlockBatch));
+  return batcher.get();
+}
+
+bool IsMatchedOffUI() {
+  return base::FeatureList::IsEnabled(
+      brave_shields::features::kBraveShieldsOffMainThreadRequestChain);
+}
+
+// Hands |ctx| over to matching once the canonical name of its host is known.
+// Returns net::OK if the chain can go on right away, which is the case when
+// OnBeforeURLRequest_AdBlockTPWork does the matching.
+int MatchWithOptionalCname(const ResponseCallback& next_callback,
+                           std::shared_ptr<BraveRequestInfo> ctx,
+                           bool cache_verdict,
+                           const base::Optional<std::string>& cname) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  task_runner->PostTaskAndReply(
-      FROM_HERE, base::BindOnce(&ShouldBlockAdOnTaskRunner, ctx, cname),
-      base::BindOnce(&OnShouldBlockAdResult, next_callback, ctx));
+  ctx->cache_adblock_verdict = cache_verdict;
+  ctx->adblock_canonical_name = cname;
+  if (IsMatchedOffUI()) {
+    ctx->adblock_match_pending = true;
+    return net::OK;
+  }
+  GetAdBlockRequestBatcher()->Add(
+      ctx, base::BindOnce(&OnShouldBlockAdsResult, next_callback, ctx));
+  return net::ERR_IO_PENDING;
+}
+
+}  // namespace
+
+void ShouldBlockAdWithOptionalCname(const ResponseCallback& next_callback,
+                                    std::shared_ptr<BraveRequestInfo> ctx,
+                                    bool cache_verdict,
+                                    const base::Optional<std::string>& cname) {
+  if (MatchWithOptionalCname(next_callback, ctx, cache_verdict, cname) ==
+      net::OK) {
+    next_callback.Run();
+  }
 }
 
 class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
  private:
   mojo::Receiver<network::mojom::ResolveHostClient> receiver_{this};
-  base::OnceCallback<void(base::Optional<std::string>)> cb_;
+  base::OnceCallback<void(const base::Optional<std::string>&)> cb_;
   base::TimeTicks start_time_;
 
  public:
   AdblockCnameResolveHostClient(
-      const ResponseCallback& next_callback,
-      scoped_refptr<base::SequencedTaskRunner> task_runner,
-      std::shared_ptr<BraveRequestInfo> ctx) {
-    cb_ = base::BindOnce(&ShouldBlockAdWithOptionalCname, task_runner,
-                         std::move(next_callback), ctx);
-
+      std::shared_ptr<BraveRequestInfo> ctx,
+      base::OnceCallback<void(const base::Optional<std::string>&)> cb)
+      : cb_(std::move(cb)) {
     auto* web_contents = GetWebContents(
         ctx->render_process_id, ctx->render_frame_id, ctx->frame_tree_node_id);
     if (!web_contents) {
       start_time_ = base::TimeTicks::Now();
-      this->OnComplete(net::ERR_FAILED, net::ResolveErrorInfo(), base::nullopt);
+      // Completing right away would run the callbacks waiting for this lookup,
+      // and so the rest of the request chain, before the caller has returned
+      // net::ERR_IO_PENDING.
+      base::SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE,
+          base::BindOnce(&AdblockCnameResolveHostClient::OnComplete,
+                         base::Unretained(this), net::ERR_FAILED,
+                         net::ResolveErrorInfo(), base::nullopt));
       return;
     }
 
@@ -190,26 +298,70 @@ class AdblockCnameResolveHostClient : public network::mojom::ResolveHostClient {
   }
 };
 
-void OnBeforeURLRequestAdBlockTP(const ResponseCallback& next_callback,
-                                 std::shared_ptr<BraveRequestInfo> ctx) {
+namespace {
+
+// Requests that can't run script or change layout, so letting one through
+// before its CNAME is known only leaks a hit the engine would otherwise have
+// caught.
+bool CanSkipCnameWait(blink::mojom::ResourceType resource_type) {
+  return resource_type == blink::mojom::ResourceType::kImage ||
+         resource_type == blink::mojom::ResourceType::kMedia ||
+         resource_type == blink::mojom::ResourceType::kFavicon ||
+         resource_type == blink::mojom::ResourceType::kPing ||
+         resource_type == blink::mojom::ResourceType::kPrefetch;
+}
+
+void OnCnameResolved(base::WeakPtr<brave_shields::CnameCache> cname_cache,
+                     const net::NetworkIsolationKey& network_isolation_key,
+                     const std::string& host,
+                     const base::Optional<std::string>& cname) {
+  if (cname_cache)
+    cname_cache->OnResolveComplete(network_isolation_key, host, cname);
+}
+
+}  // namespace
+
+int OnBeforeURLRequestAdBlockTP(const ResponseCallback& next_callback,
+                                std::shared_ptr<BraveRequestInfo> ctx) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   DCHECK_NE(ctx->request_identifier, 0UL);
   DCHECK(!ctx->request_url.is_empty());
   DCHECK(!ctx->initiator_url.is_empty());
 
-  scoped_refptr<base::SequencedTaskRunner> task_runner =
-      g_brave_browser_process->ad_block_service()->GetTaskRunner();
-
   DCHECK(ctx->browser_context);
   // DoH or standard DNS quries won't be routed through Tor, so we need to skip
   // it.
-  if (ctx->browser_context->IsTor()) {
-    ShouldBlockAdWithOptionalCname(task_runner, std::move(next_callback), ctx,
-                                   base::nullopt);
+  if (ctx->browser_context->IsTor())
+    return MatchWithOptionalCname(next_callback, ctx, true, base::nullopt);
+
+  brave_shields::CnameCache* cname_cache =
+      GetDecisionCache(*ctx)->cname_cache();
+  const std::string host = ctx->request_url.host();
+  std::string cname;
+  if (cname_cache->Get(ctx->network_isolation_key, host, &cname))
+    return MatchWithOptionalCname(next_callback, ctx, true, cname);
+
+  // Identical resolves in flight share one lookup.
+  int rv = net::ERR_IO_PENDING;
+  bool start_resolve;
+  if (base::FeatureList::IsEnabled(
+          brave_shields::features::kBraveAdblockSpeculativeCnameCheck) &&
+      CanSkipCnameWait(ctx->resource_type)) {
+    start_resolve = cname_cache->AddPendingResolve(
+        ctx->network_isolation_key, host, base::DoNothing());
+    rv = MatchWithOptionalCname(next_callback, ctx, false, base::nullopt);
   } else {
-    new AdblockCnameResolveHostClient(std::move(next_callback), task_runner,
-                                      ctx);
+    start_resolve = cname_cache->AddPendingResolve(
+        ctx->network_isolation_key, host,
+        base::BindOnce(&ShouldBlockAdWithOptionalCname, next_callback, ctx,
+                       true));
   }
+  if (start_resolve) {
+    new AdblockCnameResolveHostClient(
+        ctx, base::BindOnce(&OnCnameResolved, cname_cache->AsWeakPtr(),
+                            ctx->network_isolation_key, host));
+  }
+  return rv;
 }
 
 int OnBeforeURLRequest_AdBlockTPPreWork(const ResponseCallback& next_callback,
@@ -223,9 +375,50 @@ int OnBeforeURLRequest_AdBlockTPPreWork(const ResponseCallback& next_callback,
     return net::OK;
   }
 
-  OnBeforeURLRequestAdBlockTP(next_callback, ctx);
+  // Read once, before matching, so a verdict is looked up and cached under
+  // the same version. If the engines change while matching, the result is
+  // cached under the old version and never reused.
+  const uint64_t engine_version =
+      g_brave_browser_process->ad_block_service()->GetEngineVersion();
+
+  // Pages tend to fetch the same trackers over and over; reuse the answer
+  // instead of resolving and matching them again.
+  brave_shields::AdBlockVerdict verdict;
+  if (GetDecisionCache(*ctx)->GetAdBlockVerdict(
+          ctx->request_url, ctx->resource_type, ctx->initiator_url.host(),
+          engine_version, &verdict)) {
+    ctx->mock_data_url = verdict.mock_data_url;
+    if (verdict.blocked) {
+      ctx->blocked_by = kAdBlocked;
+      brave_shields::DispatchBlockedEvent(
+          ctx->request_url, ctx->render_frame_id, ctx->render_process_id,
+          ctx->frame_tree_node_id, brave_shields::kAds);
+    }
+    return net::OK;
+  }
 
-  return net::ERR_IO_PENDING;
+  ctx->adblock_engine_version = engine_version;
+  return OnBeforeURLRequestAdBlockTP(next_callback, ctx);
+}
+
+int OnBeforeURLRequest_AdBlockTPWork(const ResponseCallback& next_callback,
+                                     std::shared_ptr<BraveRequestInfo> ctx) {
+  if (!ctx->adblock_match_pending)
+    return net::OK;
+
+  ShouldBlockAdsOffUI({ctx});
+  return net::OK;
+}
+
+int OnBeforeURLRequest_AdBlockTPPostWork(
+    const ResponseCallback& next_callback,
+    std::shared_ptr<BraveRequestInfo> ctx) {
+  if (!ctx->adblock_match_pending)
+    return net::OK;
+
+  ctx->adblock_match_pending = false;
+  OnAdBlockMatched(*ctx);
+  return net::OK;
 }
 
 }  // namespace brave
@@ -16,6 +16,16 @@ int OnBeforeURLRequest_AdBlockTPPreWork(
     const ResponseCallback& next_callback,
     std::shared_ptr<BraveRequestInfo> ctx);
 
+// Used instead of the batched matching of the pre-work when
+// kBraveShieldsOffMainThreadRequestChain is enabled. Matching is synchronous
+// and only reads |ctx|, so it can run on any sequence; the post-work caches
+// the verdict and dispatches the blocked event on the UI thread.
+int OnBeforeURLRequest_AdBlockTPWork(const ResponseCallback& next_callback,
+                                     std::shared_ptr<BraveRequestInfo> ctx);
+int OnBeforeURLRequest_AdBlockTPPostWork(
+    const ResponseCallback& next_callback,
+    std::shared_ptr<BraveRequestInfo> ctx);
+
 }  // namespace brave
 
 #endif  // BRAVE_BROWSER_NET_BRAVE_AD_BLOCK_TP_NETWORK_DELEGATE_HELPER_H_
@@ -0,0 +1,103 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_request_batcher.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/task/thread_pool.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace brave {
+
+namespace {
+
+// A batch is flushed right away once it grows this large, even if another
+// one is still in flight.
+const size_t kMaxBatchSize = 64;
+
+}  // namespace
+
+BraveRequestBatcher::PendingRequest::PendingRequest(
+    std::shared_ptr<BraveRequestInfo> ctx,
+    DoneCallback done)
+    : ctx(std::move(ctx)), done(std::move(done)) {}
+
+BraveRequestBatcher::PendingRequest::PendingRequest(PendingRequest&& other) =
+    default;
+
+BraveRequestBatcher::PendingRequest&
+BraveRequestBatcher::PendingRequest::operator=(PendingRequest&& other) =
+    default;
+
+BraveRequestBatcher::PendingRequest::~PendingRequest() = default;
+
+BraveRequestBatcher::BraveRequestBatcher(BatchCallback work)
+    : work_(std::move(work)) {}
+
+BraveRequestBatcher::~BraveRequestBatcher() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+}
+
+void BraveRequestBatcher::Add(std::shared_ptr<BraveRequestInfo> ctx,
+                              DoneCallback done) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  pending_.emplace_back(std::move(ctx), std::move(done));
+
+  // Nothing to wait for when no batch is in flight; otherwise the request
+  // rides along with the ones queued behind that batch.
+  if (in_flight_ == 0 || pending_.size() >= kMaxBatchSize)
+    Flush();
+}
+
+void BraveRequestBatcher::Flush() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  if (pending_.empty())
+    return;
+
+  BraveRequestBatch batch;
+  std::vector<DoneCallback> done_callbacks;
+  batch.reserve(pending_.size());
+  done_callbacks.reserve(pending_.size());
+  for (auto& request : pending_) {
+    batch.push_back(std::move(request.ctx));
+    done_callbacks.push_back(std::move(request.done));
+  }
+  pending_.clear();
+  ++in_flight_;
+
+  // |batch| is released on the thread pool, so requests that have to go away
+  // on the UI thread must also be kept alive by their |done| callback.
+  base::ThreadPool::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::TaskPriority::USER_BLOCKING},
+      base::BindOnce(work_, std::move(batch)),
+      base::BindOnce(&BraveRequestBatcher::OnBatchReply,
+                     weak_factory_.GetWeakPtr(), std::move(done_callbacks)));
+}
+
+// static
+void BraveRequestBatcher::OnBatchReply(
+    base::WeakPtr<BraveRequestBatcher> batcher,
+    std::vector<DoneCallback> callbacks,
+    std::vector<int> results) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK_EQ(callbacks.size(), results.size());
+  for (size_t i = 0; i < callbacks.size(); ++i)
+    std::move(callbacks[i]).Run(results[i]);
+  // The callbacks may have destroyed the batcher.
+  if (batcher)
+    batcher->OnBatchDone();
+}
+
+void BraveRequestBatcher::OnBatchDone() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK_GT(in_flight_, 0u);
+  --in_flight_;
+  if (in_flight_ == 0)
+    Flush();
+}
+
+}  // namespace brave
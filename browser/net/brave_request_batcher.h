@@ -0,0 +1,75 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_BRAVE_REQUEST_BATCHER_H_
+#define BRAVE_BROWSER_NET_BRAVE_REQUEST_BATCHER_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "brave/browser/net/url_context.h"
+
+namespace brave {
+
+using BraveRequestBatch = std::vector<std::shared_ptr<BraveRequestInfo>>;
+
+// Collects requests issued on the UI thread and hands them to the thread pool
+// in batches, so that a page with hundreds of subresources costs a handful of
+// thread hops instead of one per request. A request added while no batch is
+// in flight is posted right away; the ones that arrive meanwhile are posted
+// together when it replies, or as soon as they fill a batch. Batches may run
+// in parallel, so the work must only touch the requests it is given and
+// thread-safe state.
+class BraveRequestBatcher {
+ public:
+  // Runs on the thread pool and returns the net error code of every request
+  // in |batch|, in the same order.
+  using BatchCallback =
+      base::RepeatingCallback<std::vector<int>(const BraveRequestBatch& batch)>;
+  using DoneCallback = base::OnceCallback<void(int rv)>;
+
+  explicit BraveRequestBatcher(BatchCallback work);
+  ~BraveRequestBatcher();
+
+  // Queues |ctx| for the next batch. |done| runs on the UI thread with its
+  // result, unless |this| is destroyed before the batch is posted.
+  void Add(std::shared_ptr<BraveRequestInfo> ctx, DoneCallback done);
+
+  size_t GetPendingCountForTesting() const { return pending_.size(); }
+
+ private:
+  struct PendingRequest {
+    PendingRequest(std::shared_ptr<BraveRequestInfo> ctx, DoneCallback done);
+    PendingRequest(PendingRequest&& other);
+    PendingRequest& operator=(PendingRequest&& other);
+    ~PendingRequest();
+
+    std::shared_ptr<BraveRequestInfo> ctx;
+    DoneCallback done;
+  };
+
+  // Runs the |done| callbacks of a batch, even if |batcher| is gone by now.
+  static void OnBatchReply(base::WeakPtr<BraveRequestBatcher> batcher,
+                           std::vector<DoneCallback> callbacks,
+                           std::vector<int> results);
+
+  void Flush();
+  void OnBatchDone();
+
+  BatchCallback work_;
+  std::vector<PendingRequest> pending_;
+  // Number of batches posted to the thread pool that haven't replied yet.
+  size_t in_flight_ = 0;
+
+  base::WeakPtrFactory<BraveRequestBatcher> weak_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(BraveRequestBatcher);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_BRAVE_REQUEST_BATCHER_H_
@@ -21,6 +21,7 @@
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_referrals/buildflags/buildflags.h"
 #include "brave/components/brave_rewards/browser/buildflags/buildflags.h"
+#include "brave/components/brave_shields/common/features.h"
 #include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
 #include "brave/components/ipfs/buildflags/buildflags.h"
 #include "chrome/browser/browser_process.h"
@@ -59,6 +60,28 @@ static bool IsInternalScheme(std::shared_ptr<brave::BraveRequestInfo> ctx) {
          ctx->request_url.SchemeIs(content::kChromeUIScheme);
 }
 
+// Runs |callbacks| in order on the thread pool for every request snapshot in
+// |batch|. Every callback is synchronous, so |next_callback| is never used.
+static std::vector<int> RunBeforeURLRequestCallbacks(
+    const std::vector<brave::OnBeforeURLRequestCallback>& callbacks,
+    const brave::BraveRequestBatch& batch) {
+  SCOPED_UMA_HISTOGRAM_TIMER("Brave.OnBeforeURLRequest_OffUIChain");
+  std::vector<int> results;
+  results.reserve(batch.size());
+  for (const auto& ctx : batch) {
+    int rv = net::OK;
+    for (const auto& callback : callbacks) {
+      ctx->next_url_request_index++;
+      rv = callback.Run(brave::ResponseCallback(), ctx);
+      DCHECK_NE(rv, net::ERR_IO_PENDING);
+      if (rv != net::OK)
+        break;
+    }
+    results.push_back(rv);
+  }
+  return results;
+}
+
 BraveRequestHandler::BraveRequestHandler() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   SetupCallbacks();
@@ -68,35 +91,59 @@ BraveRequestHandler::BraveRequestHandler() {
 
 BraveRequestHandler::~BraveRequestHandler() = default;
 
-void BraveRequestHandler::SetupCallbacks() {
-  brave::OnBeforeURLRequestCallback callback =
-      base::Bind(brave::OnBeforeURLRequest_SiteHacksWork);
+void BraveRequestHandler::AddBeforeURLRequestCallback(
+    const brave::OnBeforeURLRequestCallback& callback) {
   before_url_request_callbacks_.push_back(callback);
+}
 
-  callback = base::Bind(brave::OnBeforeURLRequest_AdBlockTPPreWork);
+void BraveRequestHandler::AddOffUIBeforeURLRequestCallback(
+    const brave::OnBeforeURLRequestCallback& callback) {
+  DCHECK(!off_ui_batcher_);
+  if (off_ui_callbacks_begin_ == off_ui_callbacks_end_) {
+    off_ui_callbacks_begin_ = before_url_request_callbacks_.size();
+  } else {
+    DCHECK_EQ(off_ui_callbacks_end_, before_url_request_callbacks_.size());
+  }
   before_url_request_callbacks_.push_back(callback);
+  off_ui_callbacks_end_ = before_url_request_callbacks_.size();
+}
 
-  callback = base::Bind(brave::OnBeforeURLRequest_HttpsePreFileWork);
-  before_url_request_callbacks_.push_back(callback);
+void BraveRequestHandler::SetupCallbacks() {
+  AddBeforeURLRequestCallback(
+      base::Bind(brave::OnBeforeURLRequest_SiteHacksWork));
+
+  AddBeforeURLRequestCallback(
+      base::Bind(brave::OnBeforeURLRequest_AdBlockTPPreWork));
+
+  if (base::FeatureList::IsEnabled(
+          brave_shields::features::kBraveShieldsOffMainThreadRequestChain)) {
+    // The pre-work above leaves matching to these when the verdict isn't
+    // cached. They run in its place, so the helpers keep their order.
+    AddOffUIBeforeURLRequestCallback(
+        base::Bind(brave::OnBeforeURLRequest_AdBlockTPWork));
+    AddBeforeURLRequestCallback(
+        base::Bind(brave::OnBeforeURLRequest_AdBlockTPPostWork));
+  }
 
-  callback = base::Bind(brave::OnBeforeURLRequest_CommonStaticRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestCallback(
+      base::Bind(brave::OnBeforeURLRequest_HttpsePreFileWork));
+
+  AddBeforeURLRequestCallback(
+      base::Bind(brave::OnBeforeURLRequest_CommonStaticRedirectWork));
 
 #if BUILDFLAG(BRAVE_REWARDS_ENABLED)
-  callback = base::Bind(brave_rewards::OnBeforeURLRequest);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestCallback(base::Bind(brave_rewards::OnBeforeURLRequest));
 #endif
 
 #if BUILDFLAG(ENABLE_BRAVE_TRANSLATE_GO)
-  callback =
-      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork);
-  before_url_request_callbacks_.push_back(callback);
+  AddBeforeURLRequestCallback(
+      base::BindRepeating(brave::OnBeforeURLRequest_TranslateRedirectWork));
 #endif
 
 #if BUILDFLAG(IPFS_ENABLED)
   if (base::FeatureList::IsEnabled(ipfs::features::kIpfsFeature)) {
-    callback = base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork);
-    before_url_request_callbacks_.push_back(callback);
+    AddBeforeURLRequestCallback(
+        base::BindRepeating(ipfs::OnBeforeURLRequest_IPFSRedirectWork));
     brave::OnHeadersReceivedCallback ipfs_headers_received_callback =
         base::Bind(ipfs::OnHeadersReceived_IPFSRedirectWork);
     headers_received_callbacks_.push_back(ipfs_headers_received_callback);
@@ -228,6 +275,46 @@ void BraveRequestHandler::RunCallbackForRequestIdentifier(
                  base::BindOnce(std::move(it->second), rv));
 }
 
+bool BraveRequestHandler::MaybeRunBeforeURLRequestCallbacksOffUI(
+    std::shared_ptr<brave::BraveRequestInfo> ctx) {
+  if (off_ui_callbacks_begin_ == off_ui_callbacks_end_ ||
+      ctx->next_url_request_index != off_ui_callbacks_begin_) {
+    return false;
+  }
+
+  if (!off_ui_batcher_) {
+    std::vector<brave::OnBeforeURLRequestCallback> callbacks(
+        before_url_request_callbacks_.begin() + off_ui_callbacks_begin_,
+        before_url_request_callbacks_.begin() + off_ui_callbacks_end_);
+    off_ui_batcher_ = std::make_unique<brave::BraveRequestBatcher>(
+        base::BindRepeating(&RunBeforeURLRequestCallbacks,
+                            std::move(callbacks)));
+  }
+
+  // The helpers only get a copy of what they read, taken now, so nothing
+  // that the UI thread owns or updates is shared with the thread pool.
+  std::shared_ptr<brave::BraveRequestInfo> snapshot = ctx->MakeOffUISnapshot();
+  off_ui_batcher_->Add(
+      snapshot,
+      base::BindOnce(&BraveRequestHandler::OnBeforeURLRequestCallbacksRunOffUI,
+                     weak_factory_.GetWeakPtr(), ctx, snapshot));
+  return true;
+}
+
+void BraveRequestHandler::OnBeforeURLRequestCallbacksRunOffUI(
+    std::shared_ptr<brave::BraveRequestInfo> ctx,
+    std::shared_ptr<brave::BraveRequestInfo> snapshot,
+    int rv) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  ctx->MergeOffUISnapshot(*snapshot);
+  if (rv == net::OK) {
+    RunNextCallback(ctx);
+    return;
+  }
+  if (IsRequestIdentifierValid(ctx->request_identifier))
+    RunCallbackForRequestIdentifier(ctx->request_identifier, rv);
+}
+
 // TODO(iefremov): Merge all callback containers into one and run only one loop
 // instead of many (issues/5574).
 void BraveRequestHandler::RunNextCallback(
@@ -244,6 +331,8 @@ void BraveRequestHandler::RunNextCallback(
   if (ctx->event_type == brave::kOnBeforeRequest) {
     while (before_url_request_callbacks_.size() !=
            ctx->next_url_request_index) {
+      if (MaybeRunBeforeURLRequestCallbacksOffUI(ctx))
+        return;
       brave::OnBeforeURLRequestCallback callback =
           before_url_request_callbacks_[ctx->next_url_request_index++];
       brave::ResponseCallback next_callback =
@@ -11,10 +11,13 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/scoped_refptr.h"
+#include "brave/browser/net/brave_request_batcher.h"
 #include "brave/browser/net/url_context.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/completion_once_callback.h"
 
+class BraveRequestHandlerTest;
 class PrefChangeRegistrar;
 
 // Contains different network stack hooks (similar to capabilities of WebRequest
@@ -52,9 +55,33 @@ class BraveRequestHandler {
   void OnPreferenceChanged(const std::string& pref_name);
   void UpdateAdBlockFromPref(const std::string& pref_name);
 
+  friend class ::BraveRequestHandlerTest;
+
+  void AddBeforeURLRequestCallback(
+      const brave::OnBeforeURLRequestCallback& callback);
+  // Adds a helper that runs on the thread pool, batched with other requests
+  // by |off_ui_batcher_|. It has to be synchronous and read nothing but |ctx|,
+  // which is a snapshot of the request, and immutable statics. These helpers
+  // must be added consecutively, so that a request hops off the UI thread at
+  // most once.
+  void AddOffUIBeforeURLRequestCallback(
+      const brave::OnBeforeURLRequestCallback& callback);
+
   void RunNextCallback(std::shared_ptr<brave::BraveRequestInfo> ctx);
 
+  // Queues a snapshot of |ctx| for the off-UI helpers if they are next for
+  // it. Returns false if the next helper runs on the UI thread.
+  bool MaybeRunBeforeURLRequestCallbacksOffUI(
+      std::shared_ptr<brave::BraveRequestInfo> ctx);
+  void OnBeforeURLRequestCallbacksRunOffUI(
+      std::shared_ptr<brave::BraveRequestInfo> ctx,
+      std::shared_ptr<brave::BraveRequestInfo> snapshot,
+      int rv);
+
   std::vector<brave::OnBeforeURLRequestCallback> before_url_request_callbacks_;
+  // The range of |before_url_request_callbacks_| that runs off the UI thread.
+  size_t off_ui_callbacks_begin_ = 0;
+  size_t off_ui_callbacks_end_ = 0;
   std::vector<brave::OnBeforeStartTransactionCallback>
       before_start_transaction_callbacks_;
   std::vector<brave::OnHeadersReceivedCallback> headers_received_callbacks_;
@@ -69,6 +96,9 @@ class BraveRequestHandler {
   std::unique_ptr<PrefChangeRegistrar, content::BrowserThread::DeleteOnUIThread>
       pref_change_registrar_;
 
+  // Created on first use, once the off-UI helpers it runs are all added.
+  std::unique_ptr<brave::BraveRequestBatcher> off_ui_batcher_;
+
   base::WeakPtrFactory<BraveRequestHandler> weak_factory_{this};
   DISALLOW_COPY_AND_ASSIGN(BraveRequestHandler);
 };
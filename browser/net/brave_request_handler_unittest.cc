@@ -0,0 +1,264 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/brave_request_handler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/synchronization/lock.h"
+#include "base/test/scoped_feature_list.h"
+#include "brave/browser/net/url_context.h"
+#include "brave/components/brave_shields/common/features.h"
+#include "chrome/test/base/scoped_testing_local_state.h"
+#include "chrome/test/base/testing_browser_process.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+class BraveRequestHandlerTest : public testing::Test {
+ public:
+  BraveRequestHandlerTest()
+      : local_state_(TestingBrowserProcess::GetGlobal()) {}
+  ~BraveRequestHandlerTest() override = default;
+
+  void SetUp() override {
+    feature_list_.InitAndEnableFeature(
+        brave_shields::features::kBraveShieldsOffMainThreadRequestChain);
+    handler_ = std::make_unique<BraveRequestHandler>();
+    // Tests provide their own helpers instead of the real ones.
+    handler_->before_url_request_callbacks_.clear();
+    handler_->off_ui_callbacks_begin_ = 0;
+    handler_->off_ui_callbacks_end_ = 0;
+  }
+
+ protected:
+  void AddHelper(const std::string& name, int rv) {
+    handler_->AddBeforeURLRequestCallback(
+        base::Bind(&BraveRequestHandlerTest::RunHelper, base::Unretained(this),
+                   name, true /* expect_ui_thread */, rv));
+  }
+
+  void AddOffUIHelper(const std::string& name, int rv) {
+    handler_->AddOffUIBeforeURLRequestCallback(
+        base::Bind(&BraveRequestHandlerTest::RunHelper, base::Unretained(this),
+                   name, false /* expect_ui_thread */, rv));
+  }
+
+  void AddRewriteHelper(const std::string& new_url_spec) {
+    handler_->AddOffUIBeforeURLRequestCallback(
+        base::Bind(&BraveRequestHandlerTest::RunRewriteHelper,
+                   base::Unretained(this), new_url_spec));
+  }
+
+  std::shared_ptr<brave::BraveRequestInfo> StartRequest(
+      uint64_t request_identifier = 1) {
+    auto ctx = std::make_shared<brave::BraveRequestInfo>(
+        GURL("https://example.com/ad_banner.png"));
+    ctx->request_identifier = request_identifier;
+    EXPECT_EQ(net::ERR_IO_PENDING,
+              handler_->OnBeforeURLRequest(
+                  ctx,
+                  base::BindOnce(&BraveRequestHandlerTest::OnRequestDone,
+                                 base::Unretained(this)),
+                  &new_url_));
+    return ctx;
+  }
+
+  std::vector<std::string> GetHelperRuns() {
+    base::AutoLock lock(lock_);
+    return helper_runs_;
+  }
+
+  size_t GetQueuedRequestCount() const {
+    return handler_->off_ui_batcher_
+               ? handler_->off_ui_batcher_->GetPendingCountForTesting()
+               : 0;
+  }
+
+  // Runs the batches posted to the thread pool and their replies.
+  void RunUntilIdle() { task_environment_.RunUntilIdle(); }
+
+  static size_t GetOffUICallbacksBegin(const BraveRequestHandler& handler) {
+    return handler.off_ui_callbacks_begin_;
+  }
+
+  static size_t GetOffUICallbacksEnd(const BraveRequestHandler& handler) {
+    return handler.off_ui_callbacks_end_;
+  }
+
+  // Thread pool tasks only run from RunUntilIdle(), so tests see the helpers
+  // run in a fixed order.
+  content::BrowserTaskEnvironment task_environment_{
+      base::test::TaskEnvironment::ThreadPoolExecutionMode::QUEUED};
+  ScopedTestingLocalState local_state_;
+  base::test::ScopedFeatureList feature_list_;
+  std::unique_ptr<BraveRequestHandler> handler_;
+  GURL new_url_;
+  bool request_done_ = false;
+  size_t requests_done_ = 0;
+  int request_rv_ = net::ERR_IO_PENDING;
+  const brave::BraveRequestInfo* rewrite_helper_ctx_ = nullptr;
+
+ private:
+  int RunHelper(const std::string& name,
+                bool expect_ui_thread,
+                int rv,
+                const brave::ResponseCallback& next_callback,
+                std::shared_ptr<brave::BraveRequestInfo> ctx) {
+    EXPECT_EQ(expect_ui_thread,
+              content::BrowserThread::CurrentlyOn(content::BrowserThread::UI))
+        << name;
+    base::AutoLock lock(lock_);
+    helper_runs_.push_back(name);
+    return rv;
+  }
+
+  int RunRewriteHelper(const std::string& new_url_spec,
+                       const brave::ResponseCallback& next_callback,
+                       std::shared_ptr<brave::BraveRequestInfo> ctx) {
+    EXPECT_FALSE(
+        content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+    rewrite_helper_ctx_ = ctx.get();
+    ctx->new_url_spec = new_url_spec;
+    return net::OK;
+  }
+
+  void OnRequestDone(int rv) {
+    request_done_ = true;
+    requests_done_++;
+    request_rv_ = rv;
+  }
+
+  base::Lock lock_;
+  std::vector<std::string> helper_runs_;
+};
+
+TEST_F(BraveRequestHandlerTest, RunsOffUIHelpersInOneHop) {
+  AddHelper("pre_work", net::OK);
+  AddOffUIHelper("match", net::OK);
+  AddOffUIHelper("match_cname", net::OK);
+  AddHelper("post_work", net::OK);
+  AddHelper("redirect", net::OK);
+
+  StartRequest();
+  // Only the helpers before the off-UI run are done synchronously.
+  EXPECT_EQ(std::vector<std::string>({"pre_work"}), GetHelperRuns());
+  EXPECT_EQ(0u, GetQueuedRequestCount());
+  EXPECT_FALSE(request_done_);
+
+  RunUntilIdle();
+  EXPECT_EQ(std::vector<std::string>(
+                {"pre_work", "match", "match_cname", "post_work", "redirect"}),
+            GetHelperRuns());
+  EXPECT_TRUE(request_done_);
+  EXPECT_EQ(net::OK, request_rv_);
+}
+
+TEST_F(BraveRequestHandlerTest, OffUIErrorStopsChain) {
+  AddHelper("pre_work", net::OK);
+  AddOffUIHelper("match", net::ERR_ABORTED);
+  AddOffUIHelper("match_cname", net::OK);
+  AddHelper("post_work", net::OK);
+
+  StartRequest();
+  RunUntilIdle();
+
+  EXPECT_EQ(std::vector<std::string>({"pre_work", "match"}), GetHelperRuns());
+  EXPECT_TRUE(request_done_);
+  EXPECT_EQ(net::ERR_ABORTED, request_rv_);
+}
+
+TEST_F(BraveRequestHandlerTest, RequestDestroyedWhileOffUI) {
+  AddHelper("pre_work", net::OK);
+  AddOffUIHelper("match", net::OK);
+  AddHelper("post_work", net::OK);
+
+  std::shared_ptr<brave::BraveRequestInfo> ctx = StartRequest();
+  // The request is already on its way to the thread pool.
+  handler_->OnURLRequestDestroyed(ctx);
+  RunUntilIdle();
+
+  EXPECT_EQ(std::vector<std::string>({"pre_work", "match"}), GetHelperRuns());
+  EXPECT_FALSE(request_done_);
+}
+
+TEST_F(BraveRequestHandlerTest, HandlerDestroyedWhileQueued) {
+  AddHelper("pre_work", net::OK);
+  AddOffUIHelper("match", net::OK);
+  AddHelper("post_work", net::OK);
+
+  StartRequest(1);
+  // Queued behind the batch of the first request.
+  StartRequest(2);
+  EXPECT_EQ(1u, GetQueuedRequestCount());
+  handler_.reset();
+  RunUntilIdle();
+
+  // Queued requests go away with the handler, and the one in flight isn't
+  // resumed.
+  EXPECT_EQ(std::vector<std::string>({"pre_work", "pre_work", "match"}),
+            GetHelperRuns());
+  EXPECT_FALSE(request_done_);
+}
+
+TEST_F(BraveRequestHandlerTest, BatchesRequests) {
+  AddHelper("pre_work", net::OK);
+  AddOffUIHelper("match", net::OK);
+  AddHelper("post_work", net::OK);
+
+  // Nothing is in flight, so the first request doesn't wait for others.
+  StartRequest(1);
+  EXPECT_EQ(0u, GetQueuedRequestCount());
+  // These two make the next hop together, once the first one is back.
+  StartRequest(2);
+  StartRequest(3);
+  EXPECT_EQ(2u, GetQueuedRequestCount());
+
+  RunUntilIdle();
+  EXPECT_EQ(0u, GetQueuedRequestCount());
+  EXPECT_EQ(3u, requests_done_);
+  EXPECT_EQ(std::vector<std::string>({"pre_work", "pre_work", "pre_work",
+                                      "match", "post_work", "match", "match",
+                                      "post_work", "post_work"}),
+            GetHelperRuns());
+}
+
+TEST_F(BraveRequestHandlerTest, RunsOffUIHelpersOnSnapshot) {
+  AddHelper("pre_work", net::OK);
+  AddRewriteHelper("https://example.com/clean.png");
+  AddHelper("post_work", net::OK);
+
+  std::shared_ptr<brave::BraveRequestInfo> ctx = StartRequest();
+  RunUntilIdle();
+
+  // The helper got a copy of the request, and what it set is taken over.
+  EXPECT_NE(nullptr, rewrite_helper_ctx_);
+  EXPECT_NE(ctx.get(), rewrite_helper_ctx_);
+  EXPECT_EQ("https://example.com/clean.png", ctx->new_url_spec);
+  EXPECT_EQ(GURL("https://example.com/clean.png"), new_url_);
+  EXPECT_TRUE(request_done_);
+  EXPECT_EQ(net::OK, request_rv_);
+}
+
+TEST_F(BraveRequestHandlerTest, OffloadsOnlyAdBlockMatching) {
+  BraveRequestHandler handler;
+  // Site hacks and the adblock pre-work run first on the UI thread. Only the
+  // adblock matching runs off it, before HTTPSE and static redirects.
+  EXPECT_EQ(2u, GetOffUICallbacksBegin(handler));
+  EXPECT_EQ(3u, GetOffUICallbacksEnd(handler));
+}
+
+TEST_F(BraveRequestHandlerTest, RunsOnUIThreadWithoutFeature) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndDisableFeature(
+      brave_shields::features::kBraveShieldsOffMainThreadRequestChain);
+  BraveRequestHandler handler;
+  EXPECT_EQ(GetOffUICallbacksBegin(handler), GetOffUICallbacksEnd(handler));
+}
@@ -8,13 +8,12 @@
 #include <memory>
 #include <string>
 
-#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/browser/brave_shields/shields_decision_cache_factory.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
+#include "brave/components/brave_shields/browser/shields_decision_cache.h"
 #include "brave/components/brave_webtorrent/browser/buildflags/buildflags.h"
 #include "brave/components/brave_webtorrent/browser/webtorrent_util.h"
 #include "brave/components/ipfs/buildflags/buildflags.h"
-#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
-#include "chrome/browser/profiles/profile.h"
 #include "content/public/browser/browser_thread.h"
 #include "net/base/isolation_info.h"
 
@@ -49,12 +48,38 @@ std::string GetUploadData(const network::ResourceRequest& request) {
 
 }  // namespace
 
+BraveRequestState::BraveRequestState() = default;
+
+BraveRequestState::BraveRequestState(const BraveRequestState& other) = default;
+
+BraveRequestState& BraveRequestState::operator=(
+    const BraveRequestState& other) = default;
+
+BraveRequestState::~BraveRequestState() = default;
+
 BraveRequestInfo::BraveRequestInfo() = default;
 
-BraveRequestInfo::BraveRequestInfo(const GURL& url) : request_url(url) {}
+BraveRequestInfo::BraveRequestInfo(const GURL& url) {
+  request_url = url;
+}
 
 BraveRequestInfo::~BraveRequestInfo() = default;
 
+std::shared_ptr<BraveRequestInfo> BraveRequestInfo::MakeOffUISnapshot() const {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  auto snapshot = std::make_shared<BraveRequestInfo>();
+  static_cast<BraveRequestState&>(*snapshot) = *this;
+  return snapshot;
+}
+
+void BraveRequestInfo::MergeOffUISnapshot(const BraveRequestInfo& snapshot) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  DCHECK_EQ(request_identifier, snapshot.request_identifier);
+  // The chain of this request waits for the off-UI helpers, so nothing else
+  // has updated its state in the meantime.
+  static_cast<BraveRequestState&>(*this) = snapshot;
+}
+
 // static
 std::shared_ptr<brave::BraveRequestInfo> BraveRequestInfo::MakeCTX(
     const network::ResourceRequest& request,
@@ -119,22 +144,23 @@ std::shared_ptr<brave::BraveRequestInfo> BraveRequestInfo::MakeCTX(
     ctx->redirect_source = old_ctx->redirect_source;
   }
 
-  Profile* profile = Profile::FromBrowserContext(browser_context);
-  auto* map = HostContentSettingsMapFactory::GetForProfile(profile);
-  ctx->allow_brave_shields =
-      brave_shields::GetBraveShieldsEnabled(map, ctx->tab_origin);
-  ctx->allow_ads = brave_shields::GetAdControlType(map, ctx->tab_origin) ==
-                   brave_shields::ControlType::ALLOW;
-  ctx->allow_http_upgradable_resource =
-      !brave_shields::GetHTTPSEverywhereEnabled(map, ctx->tab_origin);
+  auto* decision_cache =
+      brave_shields::ShieldsDecisionCacheFactory::GetForBrowserContext(
+          browser_context);
+  const brave_shields::ShieldsPolicy policy =
+      decision_cache->GetPolicy(ctx->tab_origin);
+  ctx->allow_brave_shields = policy.shields_up;
+  ctx->allow_ads = policy.allow_ads;
+  ctx->allow_http_upgradable_resource = policy.allow_http_upgradable_resource;
 
   // HACK: after we fix multiple creations of BraveRequestInfo we should
   // use only tab_origin. Since we recreate BraveRequestInfo during consequent
   // stages of navigation, |tab_origin| changes and so does |allow_referrers|
   // flag, which is not what we want for determining referrers.
-  ctx->allow_referrers = brave_shields::AllowReferrers(
-      map,
-      ctx->redirect_source.is_empty() ? ctx->tab_origin : ctx->redirect_source);
+  ctx->allow_referrers =
+      ctx->redirect_source.is_empty()
+          ? policy.allow_referrers
+          : decision_cache->GetPolicy(ctx->redirect_source).allow_referrers;
   ctx->upload_data = GetUploadData(request);
 
   ctx->browser_context = browser_context;
@@ -50,13 +50,15 @@ enum BraveNetworkDelegateEventType {
 
 enum BlockedBy { kNotBlocked, kAdBlocked, kOtherBlocked };
 
-struct BraveRequestInfo {
-  BraveRequestInfo();
-
-  // For tests, should not be used directly.
-  explicit BraveRequestInfo(const GURL& url);
+// The part of a request's state that the request helpers may read or update
+// off the UI thread. It only holds values, so it can be copied to and from the
+// thread pool as a whole.
+struct BraveRequestState {
+  BraveRequestState();
+  BraveRequestState(const BraveRequestState& other);
+  BraveRequestState& operator=(const BraveRequestState& other);
+  ~BraveRequestState();
 
-  ~BraveRequestInfo();
   std::string method;
   GURL request_url;
   GURL tab_origin;
@@ -84,22 +86,17 @@ struct BraveRequestInfo {
   uint64_t request_identifier = 0;
   size_t next_url_request_index = 0;
 
-  content::BrowserContext* browser_context = nullptr;
-  net::HttpRequestHeaders* headers = nullptr;
-  // The following two sets are populated by |OnBeforeStartTransactionCallback|.
-  // |set_headers| contains headers which values were added or modified.
-  std::set<std::string> set_headers;
-  std::set<std::string> removed_headers;
-  const net::HttpResponseHeaders* original_response_headers = nullptr;
-  scoped_refptr<net::HttpResponseHeaders>* override_response_headers = nullptr;
-
-  GURL* allowed_unsafe_redirect_url = nullptr;
   BraveNetworkDelegateEventType event_type = kUnknownEventType;
-  const base::ListValue* referral_headers_list = nullptr;
   BlockedBy blocked_by = kNotBlocked;
   std::string mock_data_url;
-  GURL ipfs_gateway_url;
-  bool ipfs_auto_fallback = false;
+
+  // Set by the adblock pre-work for the matching that follows it on the
+  // thread pool. |adblock_match_pending| is set when matching is left to
+  // OnBeforeURLRequest_AdBlockTPWork, as part of the off-UI request chain.
+  bool adblock_match_pending = false;
+  bool cache_adblock_verdict = false;
+  uint64_t adblock_engine_version = 0;
+  base::Optional<std::string> adblock_canonical_name;
 
   bool ShouldMockRequest() const { return !mock_data_url.empty(); }
 
@@ -112,9 +109,40 @@ struct BraveRequestInfo {
   static constexpr blink::mojom::ResourceType kInvalidResourceType =
       static_cast<blink::mojom::ResourceType>(-1);
   blink::mojom::ResourceType resource_type = kInvalidResourceType;
+};
+
+// Adds the state that only the UI thread may touch: pointers into objects it
+// owns, and data that only the UI-thread helpers need.
+struct BraveRequestInfo : public BraveRequestState {
+  BraveRequestInfo();
+
+  // For tests, should not be used directly.
+  explicit BraveRequestInfo(const GURL& url);
+
+  ~BraveRequestInfo();
+
+  content::BrowserContext* browser_context = nullptr;
+  net::HttpRequestHeaders* headers = nullptr;
+  // The following two sets are populated by |OnBeforeStartTransactionCallback|.
+  // |set_headers| contains headers which values were added or modified.
+  std::set<std::string> set_headers;
+  std::set<std::string> removed_headers;
+  const net::HttpResponseHeaders* original_response_headers = nullptr;
+  scoped_refptr<net::HttpResponseHeaders>* override_response_headers = nullptr;
+
+  GURL* allowed_unsafe_redirect_url = nullptr;
+  const base::ListValue* referral_headers_list = nullptr;
+  GURL ipfs_gateway_url;
+  bool ipfs_auto_fallback = false;
 
   std::string upload_data;
 
+  // Copies the state the off-UI helpers read, so that they run on a snapshot
+  // taken on the UI thread instead of sharing |this| with it.
+  std::shared_ptr<BraveRequestInfo> MakeOffUISnapshot() const;
+  // Takes over the results of the off-UI helpers from |snapshot|.
+  void MergeOffUISnapshot(const BraveRequestInfo& snapshot);
+
   static std::shared_ptr<brave::BraveRequestInfo> MakeCTX(
       const network::ResourceRequest& request,
       int render_process_id,
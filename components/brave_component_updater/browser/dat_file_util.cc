@@ -7,9 +7,11 @@
 
 #include <string>
 
+#include "base/feature_list.h"
 #include "base/logging.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "brave/components/brave_component_updater/browser/features.h"
 
 namespace brave_component_updater {
 
@@ -44,4 +46,51 @@ std::string GetDATFileAsString(const base::FilePath& file_path) {
   return contents;
 }
 
+DATFileLoadMode GetDefaultDATFileLoadMode() {
+  return base::FeatureList::IsEnabled(kMemoryMapDATFiles)
+             ? DATFileLoadMode::kMap
+             : DATFileLoadMode::kRead;
+}
+
+DATFileData::DATFileData() = default;
+
+DATFileData::~DATFileData() = default;
+
+// static
+scoped_refptr<DATFileData> DATFileData::Load(const base::FilePath& file_path,
+                                             DATFileLoadMode mode) {
+  scoped_refptr<DATFileData> data = base::WrapRefCounted(new DATFileData());
+  if (mode == DATFileLoadMode::kRead) {
+    GetDATFileData(file_path, &data->buffer_);
+  } else if (!data->mapped_file_.Initialize(file_path)) {
+    LOG(ERROR) << "DATFileData: cannot map dat file " << file_path;
+    return nullptr;
+  }
+
+  if (data->empty()) {
+    return nullptr;
+  }
+  return data;
+}
+
+// static
+scoped_refptr<DATFileData> DATFileData::Copy(const DATFileData& data) {
+  scoped_refptr<DATFileData> copy = base::WrapRefCounted(new DATFileData());
+  const unsigned char* bytes =
+      reinterpret_cast<const unsigned char*>(data.data());
+  copy->buffer_.assign(bytes, bytes + data.size());
+  return copy;
+}
+
+const char* DATFileData::data() const {
+  if (mapped_file_.IsValid())
+    return reinterpret_cast<const char*>(mapped_file_.data());
+  return buffer_.empty() ? nullptr
+                         : reinterpret_cast<const char*>(&buffer_.front());
+}
+
+size_t DATFileData::size() const {
+  return mapped_file_.IsValid() ? mapped_file_.length() : buffer_.size();
+}
+
 }  // namespace brave_component_updater
@@ -12,11 +12,55 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
 
 namespace brave_component_updater {
 
 using DATFileDataBuffer = std::vector<unsigned char>;
 
+enum class DATFileLoadMode {
+  // Copy the whole file onto the heap.
+  kRead,
+  // Map the file read-only. Pages are backed by the page cache and only
+  // become resident while they're being read. On Windows the file can't be
+  // deleted while it's mapped, so a mapping should be released once a newer
+  // version of the file has been loaded. Unmapping is a blocking call.
+  kMap,
+};
+
+// Returns kMap when the |kMemoryMapDATFiles| feature is enabled.
+DATFileLoadMode GetDefaultDATFileLoadMode();
+
+// Read-only contents of a DAT file, either copied or memory-mapped depending
+// on the DATFileLoadMode it was loaded with. The last reference must be
+// released where blocking is allowed; see DATFileLoadMode::kMap.
+class DATFileData : public base::RefCountedThreadSafe<DATFileData> {
+ public:
+  // Returns nullptr if the file is missing, empty or can't be read.
+  static scoped_refptr<DATFileData> Load(const base::FilePath& file_path,
+                                         DATFileLoadMode mode);
+  // Returns a heap copy of |data| that doesn't reference its file.
+  static scoped_refptr<DATFileData> Copy(const DATFileData& data);
+
+  const char* data() const;
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  bool is_mapped() const { return mapped_file_.IsValid(); }
+
+ private:
+  friend class base::RefCountedThreadSafe<DATFileData>;
+
+  DATFileData();
+  ~DATFileData();
+
+  DATFileDataBuffer buffer_;
+  base::MemoryMappedFile mapped_file_;
+
+  DISALLOW_COPY_AND_ASSIGN(DATFileData);
+};
+
 void GetDATFileData(const base::FilePath& file_path,
                     DATFileDataBuffer* buffer);
 std::string GetDATFileAsString(const base::FilePath& file_path);
@@ -41,6 +85,38 @@ LoadDATFileDataResult<T> LoadDATFileData(
       std::move(client), std::move(buffer));
 }
 
+template<typename T>
+using LoadDATFileResult =
+    std::pair<std::unique_ptr<T>, scoped_refptr<DATFileData>>;
+
+// Like LoadDATFileData(), but deserializes straight from a DATFileData that
+// may be memory-mapped rather than from a heap copy. The returned DATFileData
+// can be kept to deserialize further instances without reading the file
+// again.
+template<typename T>
+LoadDATFileResult<T> LoadDATFile(
+    const base::FilePath& dat_file_path,
+    DATFileLoadMode mode = GetDefaultDATFileLoadMode()) {
+  scoped_refptr<DATFileData> data = DATFileData::Load(dat_file_path, mode);
+  std::unique_ptr<T> client = std::make_unique<T>();
+  // Deserializers take a non-const pointer but never write through it, which
+  // matters since mapped pages are read-only.
+  if (!data ||
+      !client->deserialize(const_cast<char*>(data->data()), data->size()))
+    client.reset();
+
+  return LoadDATFileResult<T>(std::move(client), std::move(data));
+}
+
+// Like LoadDATFile(), for instances that don't reference the data once
+// deserialized. The data is released before returning, so this must run
+// where blocking is allowed: unmapping a file is a blocking call.
+template<typename T>
+std::unique_ptr<T> LoadDATFileAndReleaseData(
+    const base::FilePath& dat_file_path,
+    DATFileLoadMode mode = GetDefaultDATFileLoadMode()) {
+  return LoadDATFile<T>(dat_file_path, mode).first;
+}
 
 }  // namespace brave_component_updater
 
@@ -10,4 +10,8 @@ namespace brave_component_updater {
 const base::Feature kUseDevUpdaterUrl{"UseDevUpdaterUrl",
                                       base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Memory-map component DAT files instead of reading them onto the heap.
+const base::Feature kMemoryMapDATFiles{"MemoryMapDATFiles",
+                                       base::FEATURE_DISABLED_BY_DEFAULT};
+
 }  // namespace brave_component_updater
@@ -11,6 +11,7 @@
 namespace brave_component_updater {
 
 extern const base::Feature kUseDevUpdaterUrl;
+extern const base::Feature kMemoryMapDATFiles;
 
 }  // namespace brave_component_updater
 
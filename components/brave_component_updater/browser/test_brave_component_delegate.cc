@@ -0,0 +1,40 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_component_updater/browser/test_brave_component_delegate.h"
+
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace brave_component_updater {
+
+TestBraveComponentDelegate::TestBraveComponentDelegate() = default;
+
+TestBraveComponentDelegate::~TestBraveComponentDelegate() = default;
+
+void TestBraveComponentDelegate::Register(
+    const std::string& component_name,
+    const std::string& component_base64_public_key,
+    base::OnceClosure registered_callback,
+    BraveComponent::ReadyCallback ready_callback) {}
+
+bool TestBraveComponentDelegate::Unregister(const std::string& component_id) {
+  return true;
+}
+
+void TestBraveComponentDelegate::OnDemandUpdate(
+    const std::string& component_id) {}
+
+void TestBraveComponentDelegate::AddObserver(
+    BraveComponent::ComponentObserver* observer) {}
+
+void TestBraveComponentDelegate::RemoveObserver(
+    BraveComponent::ComponentObserver* observer) {}
+
+scoped_refptr<base::SequencedTaskRunner>
+TestBraveComponentDelegate::GetTaskRunner() {
+  return base::SequencedTaskRunnerHandle::Get();
+}
+
+}  // namespace brave_component_updater
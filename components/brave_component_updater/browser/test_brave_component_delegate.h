@@ -0,0 +1,41 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_COMPONENT_UPDATER_BROWSER_TEST_BRAVE_COMPONENT_DELEGATE_H_
+#define BRAVE_COMPONENTS_BRAVE_COMPONENT_UPDATER_BROWSER_TEST_BRAVE_COMPONENT_DELEGATE_H_
+
+#include <string>
+
+#include "base/macros.h"
+#include "brave/components/brave_component_updater/browser/brave_component.h"
+
+namespace brave_component_updater {
+
+// A BraveComponent::Delegate for unit tests. Components are never registered
+// with the component updater, so tests deliver component files themselves,
+// and the component task runner is the sequence the test runs on.
+class TestBraveComponentDelegate : public BraveComponent::Delegate {
+ public:
+  TestBraveComponentDelegate();
+  ~TestBraveComponentDelegate() override;
+
+  // BraveComponent::Delegate implementation
+  void Register(const std::string& component_name,
+                const std::string& component_base64_public_key,
+                base::OnceClosure registered_callback,
+                BraveComponent::ReadyCallback ready_callback) override;
+  bool Unregister(const std::string& component_id) override;
+  void OnDemandUpdate(const std::string& component_id) override;
+  void AddObserver(BraveComponent::ComponentObserver* observer) override;
+  void RemoveObserver(BraveComponent::ComponentObserver* observer) override;
+  scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TestBraveComponentDelegate);
+};
+
+}  // namespace brave_component_updater
+
+#endif  // BRAVE_COMPONENTS_BRAVE_COMPONENT_UPDATER_BROWSER_TEST_BRAVE_COMPONENT_DELEGATE_H_
@@ -75,6 +75,7 @@ void RewardsService::RegisterProfilePrefs(PrefRegistrySimple* registry) {
   registry->RegisterBooleanPref(prefs::kAutoContributeEnabled, false);
   registry->RegisterDoublePref(prefs::kAutoContributeAmount, 0.0);
   registry->RegisterUint64Pref(prefs::kNextReconcileStamp, 0ull);
+  registry->RegisterBooleanPref(prefs::kNormalizeActivityPending, false);
   registry->RegisterUint64Pref(prefs::kCreationStamp, 0ull);
   registry->RegisterStringPref(prefs::kRecoverySeed, "");
   registry->RegisterStringPref(prefs::kPaymentId, "");
@@ -45,6 +45,8 @@ const char kScoreB[] = "brave.rewards.ac.score.b";
 const char kAutoContributeEnabled[] = "brave.rewards.ac.enabled";
 const char kAutoContributeAmount[] = "brave.rewards.ac.amount";
 const char kNextReconcileStamp[] = "brave.rewards.ac.next_reconcile_stamp";
+const char kNormalizeActivityPending[] =
+    "brave.rewards.ac.normalize_activity_pending";
 const char kCreationStamp[] = "brave.rewards.creation_stamp";
 const char kRecoverySeed[] = "brave.rewards.wallet.seed";
 const char kPaymentId[] = "brave.rewards.wallet.payment_id";
@@ -24,93 +24,62 @@
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
 #include "components/prefs/pref_service.h"
 #include "content/public/browser/browser_task_traits.h"
-#include "content/public/browser/browser_thread.h"
-#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
-#include "url/origin.h"
 
 using brave_component_updater::BraveComponent;
-using content::BrowserThread;
-using namespace net::registry_controlled_domains;  // NOLINT
+
+namespace brave_shields {
 
 namespace {
 
-std::string ResourceTypeToString(blink::mojom::ResourceType resource_type) {
-  std::string filter_option = "";
-  switch (resource_type) {
-    // top level page
-    case blink::mojom::ResourceType::kMainFrame:
-      filter_option = "main_frame";
-      break;
-    // frame or iframe
-    case blink::mojom::ResourceType::kSubFrame:
-      filter_option = "sub_frame";
-      break;
-    // a CSS stylesheet
-    case blink::mojom::ResourceType::kStylesheet:
-      filter_option = "stylesheet";
-      break;
-    // an external script
-    case blink::mojom::ResourceType::kScript:
-      filter_option = "script";
-      break;
-    // an image (jpg/gif/png/etc)
-    case blink::mojom::ResourceType::kFavicon:
-    case blink::mojom::ResourceType::kImage:
-      filter_option = "image";
-      break;
-    // a font
-    case blink::mojom::ResourceType::kFontResource:
-      filter_option = "font";
-      break;
-    // an "other" subresource.
-    case blink::mojom::ResourceType::kSubResource:
-      filter_option = "other";
-      break;
-    // an object (or embed) tag for a plugin.
-    case blink::mojom::ResourceType::kObject:
-      filter_option = "object";
-      break;
-    // a media resource.
-    case blink::mojom::ResourceType::kMedia:
-      filter_option = "media";
-      break;
-    // a XMLHttpRequest
-    case blink::mojom::ResourceType::kXhr:
-      filter_option = "xhr";
-      break;
-    // a ping request for <a ping>/sendBeacon.
-    case blink::mojom::ResourceType::kPing:
-      filter_option = "ping";
-      break;
-    // the main resource of a dedicated worker.
-    case blink::mojom::ResourceType::kWorker:
-    // the main resource of a shared worker.
-    case blink::mojom::ResourceType::kSharedWorker:
-    // an explicitly requested prefetch
-    case blink::mojom::ResourceType::kPrefetch:
-    // the main resource of a service worker.
-    case blink::mojom::ResourceType::kServiceWorker:
-    // a report of Content Security Policy violations.
-    case blink::mojom::ResourceType::kCspReport:
-    // a resource that a plugin requested.
-    case blink::mojom::ResourceType::kPluginResource:
-    default:
-      break;
+// Loads the DAT file and returns data for rebuilds that doesn't keep the file
+// open. A mapped file is copied and unmapped here, where blocking is allowed,
+// since on Windows a mapped file can't be replaced or deleted by the
+// component updater.
+AdBlockBaseService::GetDATFileDataResult LoadDATFileForRebuilds(
+    const base::FilePath& dat_file_path,
+    brave_component_updater::DATFileLoadMode mode) {
+  AdBlockBaseService::GetDATFileDataResult result =
+      brave_component_updater::LoadDATFile<adblock::Engine>(dat_file_path,
+                                                            mode);
+  if (result.second && result.second->is_mapped()) {
+    result.second =
+        brave_component_updater::DATFileData::Copy(*result.second);
   }
-  return filter_option;
+  return result;
 }
 
 }  // namespace
 
-namespace brave_shields {
+AdBlockMatchRequest::AdBlockMatchRequest() = default;
+
+AdBlockMatchRequest::AdBlockMatchRequest(
+    const GURL& url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host)
+    : url(url), resource_type(resource_type), tab_host(tab_host) {}
+
+AdBlockMatchRequest::AdBlockMatchRequest(const AdBlockMatchRequest& other) =
+    default;
+
+AdBlockMatchRequest::AdBlockMatchRequest(AdBlockMatchRequest&& other) =
+    default;
+
+AdBlockMatchRequest& AdBlockMatchRequest::operator=(
+    const AdBlockMatchRequest& other) = default;
+
+AdBlockMatchRequest& AdBlockMatchRequest::operator=(
+    AdBlockMatchRequest&& other) = default;
+
+AdBlockMatchRequest::~AdBlockMatchRequest() = default;
 
 AdBlockBaseService::AdBlockBaseService(BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
-      ad_block_client_(new adblock::Engine()),
-      weak_factory_(this) {}
+      snapshot_(base::MakeRefCounted<AdBlockEngineSnapshot>(
+          std::make_unique<adblock::Engine>(),
+          std::vector<std::string>())) {}
 
 AdBlockBaseService::~AdBlockBaseService() {
-  GetTaskRunner()->DeleteSoon(FROM_HERE, ad_block_client_.release());
+  ReleaseDATFileData();
 }
 
 void AdBlockBaseService::ShouldStartRequest(
@@ -121,117 +90,231 @@ void AdBlockBaseService::ShouldStartRequest(
     bool* did_match_exception,
     bool* did_match_important,
     std::string* mock_data_url) {
-  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  GetEngineSnapshot()->ShouldStartRequest(
+      url, resource_type, tab_host, did_match_rule, did_match_exception,
+      did_match_important, mock_data_url);
+}
 
-  // Determine third-party here so the library doesn't need to figure it out.
-  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
-  // a URL or origin and not a string to a host name.
-  bool is_third_party = !SameDomainOrHost(
-      url,
-      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
-      INCLUDE_PRIVATE_REGISTRIES);
-  ad_block_client_->matches(
-      url.spec(), url.host(), tab_host, is_third_party,
-      ResourceTypeToString(resource_type), did_match_rule,
-      did_match_exception, did_match_important, mock_data_url);
-
-  // LOG(ERROR) << "AdBlockBaseService::ShouldStartRequest(), host: "
-  //  << tab_host
-  //  << ", resource type: " << resource_type
-  //  << ", url.spec(): " << url.spec();
+void AdBlockBaseService::ShouldStartRequests(AdBlockMatchRequests* requests) {
+  DCHECK(requests);
+  // Matches against this service's own engine only. Calling the virtual
+  // ShouldStartRequest here would make subclasses consult the engines they
+  // chain to once per request on top of their own batched calls.
+  scoped_refptr<AdBlockEngineSnapshot> snapshot = GetEngineSnapshot();
+  for (auto& request : *requests) {
+    if (request.did_match_important)
+      continue;
+    snapshot->ShouldStartRequest(
+        request.url, request.resource_type, request.tab_host,
+        &request.did_match_rule, &request.did_match_exception,
+        &request.did_match_important, &request.mock_data_url);
+  }
 }
 
 void AdBlockBaseService::EnableTag(const std::string& tag, bool enabled) {
-  if (BrowserThread::CurrentlyOn(BrowserThread::UI)) {
+  {
+    base::AutoLock lock(requested_tags_lock_);
+    if (enabled) {
+      requested_tags_.insert(tag);
+    } else {
+      requested_tags_.erase(tag);
+    }
+  }
+
+  if (!GetTaskRunner()->RunsTasksInCurrentSequence()) {
     GetTaskRunner()->PostTask(
-        FROM_HERE, base::BindOnce(&AdBlockBaseService::EnableTag,
+        FROM_HERE, base::BindOnce(&AdBlockBaseService::UpdateTag,
                                   base::Unretained(this), tag, enabled));
     return;
   }
+  UpdateTag(tag, enabled);
+}
 
+void AdBlockBaseService::UpdateTag(const std::string& tag, bool enabled) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  std::vector<std::string>::iterator it =
+      std::find(tags_.begin(), tags_.end(), tag);
+  if (enabled == (it != tags_.end()))
+    return;
   if (enabled) {
-    ad_block_client_->addTag(tag);
     tags_.push_back(tag);
   } else {
-    ad_block_client_->removeTag(tag);
-    std::vector<std::string>::iterator it =
-        std::find(tags_.begin(), tags_.end(), tag);
-    if (it != tags_.end()) {
-      tags_.erase(it);
-    }
+    tags_.erase(it);
   }
+  ScheduleRebuild();
 }
 
 void AdBlockBaseService::AddResources(const std::string& resources) {
-  if (BrowserThread::CurrentlyOn(BrowserThread::UI)) {
+  if (!GetTaskRunner()->RunsTasksInCurrentSequence()) {
     GetTaskRunner()->PostTask(
         FROM_HERE, base::BindOnce(&AdBlockBaseService::AddResources,
                                   base::Unretained(this), resources));
     return;
   }
 
-  ad_block_client_->addResources(resources);
+  if (resources_ == resources)
+    return;
   resources_ = resources;
+  ScheduleRebuild();
 }
 
 bool AdBlockBaseService::TagExists(const std::string& tag) {
-  return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
+  // Answered from the requested tags rather than the published snapshot,
+  // which only picks up a change once the rebuild it triggers is done.
+  base::AutoLock lock(requested_tags_lock_);
+  return requested_tags_.find(tag) != requested_tags_.end();
+}
+
+scoped_refptr<AdBlockEngineSnapshot> AdBlockBaseService::GetEngineSnapshot()
+    const {
+  base::AutoLock lock(snapshot_lock_);
+  return snapshot_;
 }
 
 base::Optional<base::Value> AdBlockBaseService::UrlCosmeticResources(
         const std::string& url) {
-  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  return base::JSONReader::Read(ad_block_client_->urlCosmeticResources(url));
+  return base::JSONReader::Read(
+      GetEngineSnapshot()->UrlCosmeticResources(url));
 }
 
 base::Optional<base::Value> AdBlockBaseService::HiddenClassIdSelectors(
         const std::vector<std::string>& classes,
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
-  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
   return base::JSONReader::Read(
-      ad_block_client_->hiddenClassIdSelectors(classes, ids, exceptions));
+      GetEngineSnapshot()->HiddenClassIdSelectors(classes, ids, exceptions));
 }
 
 void AdBlockBaseService::GetDATFileData(const base::FilePath& dat_file_path) {
+  GetTaskRunner()->PostTask(
+      FROM_HERE, base::BindOnce(&AdBlockBaseService::LoadDATFileData,
+                                base::Unretained(this), dat_file_path));
+}
+
+void AdBlockBaseService::LoadDATFileData(const base::FilePath& dat_file_path) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  pending_dat_file_loads_++;
+  // Loaded on the thread pool so that other components sharing
+  // |GetTaskRunner()| aren't held up. The reply comes back to this sequence,
+  // where the data is kept, so it's never released on the UI thread.
   base::PostTaskAndReplyWithResult(
       FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-      base::BindOnce(&brave_component_updater::LoadDATFileData<adblock::Engine>,
-                     dat_file_path),
+      base::BindOnce(&LoadDATFileForRebuilds, dat_file_path,
+                     brave_component_updater::GetDefaultDATFileLoadMode()),
       base::BindOnce(&AdBlockBaseService::OnGetDATFileData,
-                     weak_factory_.GetWeakPtr()));
+                     base::Unretained(this)));
 }
 
 void AdBlockBaseService::OnGetDATFileData(GetDATFileDataResult result) {
-  if (result.second.empty()) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  DCHECK_GT(pending_dat_file_loads_, 0);
+  pending_dat_file_loads_--;
+
+  if (!result.second) {
     LOG(ERROR) << "Could not obtain ad block data";
+  } else if (!result.first) {
+    LOG(ERROR) << "Failed to deserialize ad block data";
+  }
+  if (!result.first) {
+    // Changes deferred for this load still apply to the current engine.
+    if (needs_rebuild_)
+      ScheduleRebuild();
     return;
   }
-  if (!result.first.get()) {
-    LOG(ERROR) << "Failed to deserialize ad block data";
+
+  dat_file_data_ = std::move(result.second);
+  rules_.clear();
+  PublishEngine(std::move(result.first));
+}
+
+void AdBlockBaseService::UpdateRules(const std::string& rules) {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  ReleaseDATFileData();
+  rules_ = rules;
+  RebuildEngine();
+}
+
+void AdBlockBaseService::ReleaseDATFileData() {
+  if (!dat_file_data_)
+    return;
+  if (GetTaskRunner()->RunsTasksInCurrentSequence()) {
+    dat_file_data_ = nullptr;
     return;
   }
   GetTaskRunner()->PostTask(
-      FROM_HERE, base::BindOnce(&AdBlockBaseService::UpdateAdBlockClient,
-                                base::Unretained(this),
-                                std::move(result.first)));
+      FROM_HERE,
+      base::BindOnce(
+          [](scoped_refptr<brave_component_updater::DATFileData>) {},
+          std::move(dat_file_data_)));
 }
 
-void AdBlockBaseService::UpdateAdBlockClient(
-    std::unique_ptr<adblock::Engine> ad_block_client) {
+std::unique_ptr<adblock::Engine> AdBlockBaseService::CreateEngine() const {
+  if (!dat_file_data_)
+    return std::make_unique<adblock::Engine>(rules_);
+
+  // Deserialized again from the data kept in memory, which is cheaper than
+  // reading the DAT file, and leaves the published engine untouched.
+  auto engine = std::make_unique<adblock::Engine>();
+  if (!engine->deserialize(const_cast<char*>(dat_file_data_->data()),
+                           dat_file_data_->size())) {
+    LOG(ERROR) << "Failed to deserialize ad block data";
+    return nullptr;
+  }
+  return engine;
+}
+
+void AdBlockBaseService::ScheduleRebuild() {
+  DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
+  needs_rebuild_ = true;
+  // A DAT file that is still loading picks up the change when it's published.
+  if (rebuild_scheduled_ || pending_dat_file_loads_ > 0)
+    return;
+  // Posted rather than run right away so that changes which are already
+  // queued, like the tags enabled at startup, share one rebuild.
+  rebuild_scheduled_ = true;
+  GetTaskRunner()->PostTask(
+      FROM_HERE, base::BindOnce(&AdBlockBaseService::RebuildEngineIfNeeded,
+                                base::Unretained(this)));
+}
+
+void AdBlockBaseService::RebuildEngineIfNeeded() {
   DCHECK(GetTaskRunner()->RunsTasksInCurrentSequence());
-  ad_block_client_ = std::move(ad_block_client);
-  AddKnownTagsToAdBlockInstance();
-  AddKnownResourcesToAdBlockInstance();
+  rebuild_scheduled_ = false;
+  if (!needs_rebuild_ || pending_dat_file_loads_ > 0)
+    return;
+  RebuildEngine();
 }
 
-void AdBlockBaseService::AddKnownTagsToAdBlockInstance() {
-  std::for_each(tags_.begin(), tags_.end(),
-                [&](const std::string tag) { ad_block_client_->addTag(tag); });
+void AdBlockBaseService::RebuildEngine() {
+  std::unique_ptr<adblock::Engine> engine = CreateEngine();
+  if (!engine) {
+    // Keep matching with the previous snapshot rather than publishing an
+    // empty engine, which would silently disable blocking.
+    needs_rebuild_ = false;
+    return;
+  }
+  PublishEngine(std::move(engine));
 }
 
-void AdBlockBaseService::AddKnownResourcesToAdBlockInstance() {
-  ad_block_client_->addResources(resources_);
+void AdBlockBaseService::PublishEngine(
+    std::unique_ptr<adblock::Engine> engine) {
+  DCHECK(engine);
+  for (const auto& tag : tags_)
+    engine->addTag(tag);
+  engine->addResources(resources_);
+  needs_rebuild_ = false;
+
+  auto snapshot =
+      base::MakeRefCounted<AdBlockEngineSnapshot>(std::move(engine), tags_);
+  {
+    base::AutoLock lock(snapshot_lock_);
+    snapshot_.swap(snapshot);
+  }
+  // Bumped only once the new snapshot is visible, so a lookup that reads the
+  // new generation also matches against the new engine.
+  BumpAdBlockEngineGeneration();
+  // The previous snapshot is deleted once the last in-flight lookup using it
+  // is done.
 }
 
 bool AdBlockBaseService::Init() {
@@ -243,12 +326,12 @@ void AdBlockBaseService::ResetForTest(const std::string& rules,
   // This is temporary until adblock-rust supports incrementally adding
   // filter rules to an existing instance. At which point the hack below
   // will dissapear.
-  ad_block_client_.reset(new adblock::Engine(rules));
-  AddKnownTagsToAdBlockInstance();
   if (!resources.empty()) {
     resources_ = resources;
   }
-  AddKnownResourcesToAdBlockInstance();
+  ReleaseDATFileData();
+  rules_ = rules;
+  RebuildEngine();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
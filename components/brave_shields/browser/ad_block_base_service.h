@@ -9,19 +9,26 @@
 #include <stdint.h>
 
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
+#include "base/synchronization/lock.h"
 #include "base/values.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_snapshot.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 
+class AdBlockBaseServiceTest;
+class AdBlockRegionalServiceManagerTest;
 class AdBlockServiceTest;
+class AdBlockServiceUnitTest;
 
 using brave_component_updater::BraveComponent;
 namespace adblock {
@@ -30,12 +37,47 @@ class Engine;
 
 namespace brave_shields {
 
+// A single network request matched as part of a batch by
+// |AdBlockBaseService::ShouldStartRequests|. Match results are accumulated
+// in place so that several engines can be consulted in turn.
+struct AdBlockMatchRequest {
+  AdBlockMatchRequest();
+  AdBlockMatchRequest(const GURL& url,
+                      blink::mojom::ResourceType resource_type,
+                      const std::string& tab_host);
+  AdBlockMatchRequest(const AdBlockMatchRequest& other);
+  AdBlockMatchRequest(AdBlockMatchRequest&& other);
+  AdBlockMatchRequest& operator=(const AdBlockMatchRequest& other);
+  AdBlockMatchRequest& operator=(AdBlockMatchRequest&& other);
+  ~AdBlockMatchRequest();
+
+  GURL url;
+  blink::mojom::ResourceType resource_type =
+      blink::mojom::ResourceType::kSubResource;
+  std::string tab_host;
+  bool did_match_rule = false;
+  bool did_match_exception = false;
+  bool did_match_important = false;
+  std::string mock_data_url;
+};
+
+using AdBlockMatchRequests = std::vector<AdBlockMatchRequest>;
+
 // The base class of the brave shields service in charge of ad-block
 // checking and init.
+//
+// Matching is done against an immutable |AdBlockEngineSnapshot| and may
+// happen on any thread. Configuration changes (list updates, tags and
+// resources) are applied on |GetTaskRunner()| by building and publishing a
+// new snapshot, so in-flight lookups are never stalled by them. Changes that
+// arrive together are coalesced into a single rebuild, and changes made while
+// a DAT file is loading are applied to the loaded engine before it's
+// published. A heap copy of the loaded DAT data is kept so that rebuilds
+// deserialize a fresh engine from memory instead of reading the file again.
 class AdBlockBaseService : public BaseBraveShieldsService {
  public:
   using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<adblock::Engine>;
+      brave_component_updater::LoadDATFileResult<adblock::Engine>;
 
   explicit AdBlockBaseService(BraveComponent::Delegate* delegate);
   ~AdBlockBaseService() override;
@@ -47,10 +89,18 @@ class AdBlockBaseService : public BaseBraveShieldsService {
                           bool* did_match_exception,
                           bool* did_match_important,
                           std::string* mock_data_url) override;
+  // Matches every request in |requests| against this engine in one go.
+  // Requests that already matched an important rule are skipped.
+  virtual void ShouldStartRequests(AdBlockMatchRequests* requests);
   void AddResources(const std::string& resources);
   void EnableTag(const std::string& tag, bool enabled);
+  // Whether |tag| is enabled, including changes that haven't been published
+  // to the engine yet.
   bool TagExists(const std::string& tag);
 
+  // Returns the currently published engine. Safe to call from any thread.
+  scoped_refptr<AdBlockEngineSnapshot> GetEngineSnapshot() const;
+
   virtual base::Optional<base::Value> UrlCosmeticResources(
       const std::string& url);
   virtual base::Optional<base::Value> HiddenClassIdSelectors(
@@ -59,25 +109,54 @@ class AdBlockBaseService : public BaseBraveShieldsService {
       const std::vector<std::string>& exceptions);
 
  protected:
+  friend class ::AdBlockBaseServiceTest;
+  friend class ::AdBlockRegionalServiceManagerTest;
   friend class ::AdBlockServiceTest;
+  friend class ::AdBlockServiceUnitTest;
   bool Init() override;
 
   void GetDATFileData(const base::FilePath& dat_file_path);
-  void AddKnownTagsToAdBlockInstance();
-  void AddKnownResourcesToAdBlockInstance();
+  // Replaces the filter rules the engine is built from and publishes a new
+  // snapshot. Must be called on |GetTaskRunner()|.
+  void UpdateRules(const std::string& rules);
   void ResetForTest(const std::string& rules, const std::string& resources);
 
-  std::unique_ptr<adblock::Engine> ad_block_client_;
-
  private:
-  void UpdateAdBlockClient(
-      std::unique_ptr<adblock::Engine> ad_block_client);
+  void LoadDATFileData(const base::FilePath& dat_file_path);
   void OnGetDATFileData(GetDATFileDataResult result);
+  void UpdateTag(const std::string& tag, bool enabled);
   void OnPreferenceChanges(const std::string& pref_name);
-
+  // Releases |dat_file_data_| on |GetTaskRunner()|, which owns it, so that
+  // freeing a large buffer never happens on the calling thread.
+  void ReleaseDATFileData();
+  // Returns nullptr if the kept DAT data can't be deserialized.
+  std::unique_ptr<adblock::Engine> CreateEngine() const;
+  void ScheduleRebuild();
+  void RebuildEngineIfNeeded();
+  void RebuildEngine();
+  void PublishEngine(std::unique_ptr<adblock::Engine> engine);
+
+  // What the engine is built from, kept so that tag and resource changes can
+  // build a new snapshot without touching the published one. Only accessed
+  // on |GetTaskRunner()|. |dat_file_data_| is never mapped, so the DAT file
+  // can be replaced while the engine is live.
+  scoped_refptr<brave_component_updater::DATFileData> dat_file_data_;
+  std::string rules_;
   std::vector<std::string> tags_;
   std::string resources_;
-  base::WeakPtrFactory<AdBlockBaseService> weak_factory_;
+  // Set when tags or resources changed since the last published snapshot.
+  bool needs_rebuild_ = false;
+  bool rebuild_scheduled_ = false;
+  int pending_dat_file_loads_ = 0;
+
+  // The tags as requested through EnableTag(), ahead of the engine.
+  base::Lock requested_tags_lock_;
+  std::set<std::string> requested_tags_;
+
+  // Guards |snapshot_| itself; it is only held long enough to copy or swap
+  // the reference, never while matching.
+  mutable base::Lock snapshot_lock_;
+  scoped_refptr<AdBlockEngineSnapshot> snapshot_;
   DISALLOW_COPY_AND_ASSIGN(AdBlockBaseService);
 };
 
@@ -0,0 +1,307 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
+
+#include <memory>
+#include <string>
+
+#include "base/base_paths.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/path_service.h"
+#include "base/test/scoped_feature_list.h"
+#include "brave/components/brave_component_updater/browser/features.h"
+#include "brave/components/brave_component_updater/browser/test_brave_component_delegate.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_snapshot.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+const char kAdBannerURL[] = "https://example.com/ad_banner.png";
+const char kMockMeURL[] = "https://example.com/js_mock_me.js";
+const char kTabHost[] = "example.com";
+
+const char kRedirectRules[] = "js_mock_me.js$redirect=noopjs";
+const char kNoopJsResources[] = R"([{
+    "name": "noop.js",
+    "aliases": ["noopjs"],
+    "kind": {"mime": "application/javascript"},
+    "content": "KGZ1bmN0aW9uKCkgewogICAgJ3VzZSBzdHJpY3QnOwp9KSgpOwo="
+  }])";
+
+void TestDomainResolver(const char* host, uint32_t* start, uint32_t* end) {
+  const std::string host_str(host);
+  const std::string domain =
+      net::registry_controlled_domains::GetDomainAndRegistry(
+          host_str,
+          net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  const size_t match = host_str.rfind(domain);
+  *start = match != std::string::npos ? match : 0;
+  *end = match != std::string::npos ? match + domain.length()
+                                    : host_str.length();
+}
+
+struct MatchResult {
+  bool did_match_rule = false;
+  bool did_match_exception = false;
+  bool did_match_important = false;
+  std::string mock_data_url;
+};
+
+MatchResult Match(const brave_shields::AdBlockEngineSnapshot& snapshot,
+                  const std::string& url,
+                  blink::mojom::ResourceType resource_type) {
+  MatchResult result;
+  snapshot.ShouldStartRequest(GURL(url), resource_type, kTabHost,
+                              &result.did_match_rule,
+                              &result.did_match_exception,
+                              &result.did_match_important,
+                              &result.mock_data_url);
+  return result;
+}
+
+}  // namespace
+
+class AdBlockBaseServiceTest : public testing::Test {
+ public:
+  AdBlockBaseServiceTest()
+      : service_(std::make_unique<brave_shields::AdBlockBaseService>(
+            &component_delegate_)) {}
+  ~AdBlockBaseServiceTest() override = default;
+
+  void SetUp() override { adblock::SetDomainResolver(TestDomainResolver); }
+
+ protected:
+  base::FilePath GetDefaultDATFilePath() {
+    base::FilePath source_root;
+    base::PathService::Get(base::DIR_SOURCE_ROOT, &source_root);
+    return source_root.AppendASCII("brave")
+        .AppendASCII("test")
+        .AppendASCII("data")
+        .AppendASCII("adblock-data")
+        .AppendASCII("adblock-default")
+        .AppendASCII("rs-ABPFilterParserData.dat");
+  }
+
+  // Loads |dat_file_path| like a component update would and waits for the
+  // engine to be published.
+  void LoadDATFile(const base::FilePath& dat_file_path) {
+    service_->GetDATFileData(dat_file_path);
+    task_environment_.RunUntilIdle();
+  }
+
+  void UpdateRules(const std::string& rules) { service_->UpdateRules(rules); }
+
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> GetEngineSnapshot() {
+    return service_->GetEngineSnapshot();
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  brave_component_updater::TestBraveComponentDelegate component_delegate_;
+  std::unique_ptr<brave_shields::AdBlockBaseService> service_;
+};
+
+TEST_F(AdBlockBaseServiceTest, PublishingDoesNotChangePreviousSnapshot) {
+  UpdateRules("*ad_banner.png");
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> previous_snapshot =
+      GetEngineSnapshot();
+
+  UpdateRules("");
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+
+  ASSERT_NE(previous_snapshot, snapshot);
+  EXPECT_GT(snapshot->version(), previous_snapshot->version());
+  // Lookups that started with the previous snapshot keep its rules.
+  EXPECT_TRUE(Match(*previous_snapshot, kAdBannerURL,
+                    blink::mojom::ResourceType::kImage)
+                  .did_match_rule);
+  EXPECT_FALSE(
+      Match(*snapshot, kAdBannerURL, blink::mojom::ResourceType::kImage)
+          .did_match_rule);
+}
+
+TEST_F(AdBlockBaseServiceTest, CoalescesTagAndResourceChanges) {
+  UpdateRules(kRedirectRules);
+  const uint64_t version = GetEngineSnapshot()->version();
+
+  service_->EnableTag("fb-embeds", true);
+  service_->EnableTag("twitter-embeds", true);
+  service_->EnableTag("linked-in-embeds", true);
+  service_->AddResources(kNoopJsResources);
+  task_environment_.RunUntilIdle();
+
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+  EXPECT_EQ(version + 1, snapshot->version());
+  EXPECT_TRUE(snapshot->TagExists("fb-embeds"));
+  EXPECT_TRUE(snapshot->TagExists("twitter-embeds"));
+  EXPECT_TRUE(snapshot->TagExists("linked-in-embeds"));
+  EXPECT_FALSE(
+      Match(*snapshot, kMockMeURL, blink::mojom::ResourceType::kScript)
+          .mock_data_url.empty());
+}
+
+TEST_F(AdBlockBaseServiceTest, DoesNotRebuildForUnchangedTagsOrResources) {
+  service_->EnableTag("fb-embeds", true);
+  service_->AddResources(kNoopJsResources);
+  task_environment_.RunUntilIdle();
+  const uint64_t version = GetEngineSnapshot()->version();
+
+  service_->EnableTag("fb-embeds", true);
+  service_->EnableTag("twitter-embeds", false);
+  service_->AddResources(kNoopJsResources);
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(version, GetEngineSnapshot()->version());
+}
+
+TEST_F(AdBlockBaseServiceTest, AppliesChangesMadeWhileLoadingToLoadedEngine) {
+  const uint64_t version = GetEngineSnapshot()->version();
+
+  service_->GetDATFileData(GetDefaultDATFilePath());
+  service_->EnableTag("fb-embeds", true);
+  service_->AddResources(kNoopJsResources);
+  task_environment_.RunUntilIdle();
+
+  // Only the loaded engine is published, already configured.
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+  EXPECT_EQ(version + 1, snapshot->version());
+  EXPECT_TRUE(snapshot->TagExists("fb-embeds"));
+  EXPECT_TRUE(
+      Match(*snapshot, kAdBannerURL, blink::mojom::ResourceType::kImage)
+          .did_match_rule);
+}
+
+TEST_F(AdBlockBaseServiceTest, TagsAndResourcesSurviveDATFileReload) {
+  service_->EnableTag("fb-embeds", true);
+  service_->AddResources(kNoopJsResources);
+  LoadDATFile(GetDefaultDATFilePath());
+  const uint64_t version = GetEngineSnapshot()->version();
+
+  LoadDATFile(GetDefaultDATFilePath());
+
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+  EXPECT_GT(snapshot->version(), version);
+  EXPECT_TRUE(snapshot->TagExists("fb-embeds"));
+  EXPECT_TRUE(
+      Match(*snapshot, kAdBannerURL, blink::mojom::ResourceType::kImage)
+          .did_match_rule);
+
+  // The resources are still applied once the engine is rebuilt from rules.
+  UpdateRules(kRedirectRules);
+  EXPECT_FALSE(Match(*GetEngineSnapshot(), kMockMeURL,
+                     blink::mojom::ResourceType::kScript)
+                   .mock_data_url.empty());
+}
+
+TEST_F(AdBlockBaseServiceTest, KeepsSnapshotWhenDATFileFailsToLoad) {
+  LoadDATFile(GetDefaultDATFilePath());
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath invalid_dat_file_path =
+      temp_dir.GetPath().AppendASCII("rs-ABPFilterParserData.dat");
+  const std::string invalid_dat_file = "not a serialized engine";
+  ASSERT_EQ(static_cast<int>(invalid_dat_file.size()),
+            base::WriteFile(invalid_dat_file_path, invalid_dat_file.data(),
+                            invalid_dat_file.size()));
+
+  LoadDATFile(invalid_dat_file_path);
+  EXPECT_EQ(snapshot, GetEngineSnapshot());
+
+  LoadDATFile(temp_dir.GetPath().AppendASCII("missing.dat"));
+  EXPECT_EQ(snapshot, GetEngineSnapshot());
+
+  // Changes deferred while the failed loads were pending still apply.
+  service_->GetDATFileData(invalid_dat_file_path);
+  service_->EnableTag("fb-embeds", true);
+  task_environment_.RunUntilIdle();
+  EXPECT_TRUE(GetEngineSnapshot()->TagExists("fb-embeds"));
+  EXPECT_TRUE(Match(*GetEngineSnapshot(), kAdBannerURL,
+                    blink::mojom::ResourceType::kImage)
+                  .did_match_rule);
+}
+
+TEST_F(AdBlockBaseServiceTest, RebuildsFromLoadedDATDataWithoutTheFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath dat_file_path =
+      temp_dir.GetPath().AppendASCII("rs-ABPFilterParserData.dat");
+  ASSERT_TRUE(base::CopyFile(GetDefaultDATFilePath(), dat_file_path));
+
+  LoadDATFile(dat_file_path);
+  const uint64_t version = GetEngineSnapshot()->version();
+  ASSERT_TRUE(base::DeleteFile(dat_file_path));
+
+  // Tag and resource changes don't need the file to be read again.
+  service_->EnableTag("fb-embeds", true);
+  service_->AddResources(kNoopJsResources);
+  task_environment_.RunUntilIdle();
+
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+  EXPECT_EQ(version + 1, snapshot->version());
+  EXPECT_TRUE(snapshot->TagExists("fb-embeds"));
+  EXPECT_TRUE(
+      Match(*snapshot, kAdBannerURL, blink::mojom::ResourceType::kImage)
+          .did_match_rule);
+}
+
+TEST_F(AdBlockBaseServiceTest, RebuildsFromMappedDATDataWithoutTheFile) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(
+      brave_component_updater::kMemoryMapDATFiles);
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath dat_file_path =
+      temp_dir.GetPath().AppendASCII("rs-ABPFilterParserData.dat");
+  ASSERT_TRUE(base::CopyFile(GetDefaultDATFilePath(), dat_file_path));
+
+  LoadDATFile(dat_file_path);
+  const uint64_t version = GetEngineSnapshot()->version();
+  ASSERT_TRUE(service_->dat_file_data_);
+  EXPECT_FALSE(service_->dat_file_data_->is_mapped());
+  // The file isn't held open while the engine is live, so a component update
+  // can delete it, which fails on Windows for a mapped file.
+  ASSERT_TRUE(base::DeleteFile(dat_file_path));
+
+  service_->EnableTag("fb-embeds", true);
+  task_environment_.RunUntilIdle();
+
+  scoped_refptr<brave_shields::AdBlockEngineSnapshot> snapshot =
+      GetEngineSnapshot();
+  EXPECT_EQ(version + 1, snapshot->version());
+  EXPECT_TRUE(snapshot->TagExists("fb-embeds"));
+  EXPECT_TRUE(
+      Match(*snapshot, kAdBannerURL, blink::mojom::ResourceType::kImage)
+          .did_match_rule);
+}
+
+TEST_F(AdBlockBaseServiceTest, TagExistsReflectsChangesBeforeRebuild) {
+  LoadDATFile(GetDefaultDATFilePath());
+
+  service_->EnableTag("fb-embeds", true);
+  EXPECT_TRUE(service_->TagExists("fb-embeds"));
+  service_->EnableTag("fb-embeds", false);
+  EXPECT_FALSE(service_->TagExists("fb-embeds"));
+  service_->EnableTag("twitter-embeds", true);
+  EXPECT_TRUE(service_->TagExists("twitter-embeds"));
+
+  task_environment_.RunUntilIdle();
+  EXPECT_FALSE(GetEngineSnapshot()->TagExists("fb-embeds"));
+  EXPECT_TRUE(GetEngineSnapshot()->TagExists("twitter-embeds"));
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_paths.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/path_service.h"
+#include "base/process/process_metrics.h"
+#include "base/timer/elapsed_timer.h"
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+using brave_component_updater::DATFileLoadMode;
+using brave_component_updater::LoadDATFile;
+using brave_component_updater::LoadDATFileResult;
+
+namespace brave_shields {
+
+namespace {
+
+// Path of a full adblock DAT to measure, e.g. the default list from an
+// installed component. The small DAT from the test data is used otherwise.
+constexpr char kDATFileSwitch[] = "adblock-dat-file";
+// The default list plus a handful of regional lists.
+constexpr size_t kNumEngines = 6;
+
+constexpr char kMetricPrefix[] = "AdBlockDATFile.";
+constexpr char kMetricLoadTime[] = "load_time";
+constexpr char kMetricResidentSetDelta[] = "resident_set_delta";
+constexpr char kMetricResidentSetDeltaReleased[] =
+    "resident_set_delta_data_released";
+
+size_t GetResidentSetSize() {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  return base::ProcessMetrics::CreateCurrentProcessMetrics()
+      ->GetResidentSetSize();
+#else
+  return 0;
+#endif
+}
+
+size_t GetResidentSetDelta(size_t before) {
+  const size_t after = GetResidentSetSize();
+  return after > before ? after - before : 0;
+}
+
+class AdBlockDATFilePerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    dat_file_path_ =
+        base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(
+            kDATFileSwitch);
+    if (dat_file_path_.empty()) {
+      base::PathService::Get(base::DIR_SOURCE_ROOT, &dat_file_path_);
+      dat_file_path_ = dat_file_path_.AppendASCII("brave")
+                           .AppendASCII("test")
+                           .AppendASCII("data")
+                           .AppendASCII("adblock-data")
+                           .AppendASCII("adblock-default")
+                           .AppendASCII("rs-ABPFilterParserData.dat");
+    }
+  }
+
+  // Loads |kNumEngines| engines from the DAT file with |mode|, the way the
+  // adblock services do at startup, and reports the time it took and how
+  // much the resident set grew.
+  void RunTest(DATFileLoadMode mode, const std::string& story) {
+    perf_test::PerfResultReporter reporter(kMetricPrefix, story);
+    reporter.RegisterImportantMetric(kMetricLoadTime, "ms");
+    reporter.RegisterImportantMetric(kMetricResidentSetDelta, "bytes");
+    reporter.RegisterImportantMetric(kMetricResidentSetDeltaReleased,
+                                     "bytes");
+
+    std::vector<LoadDATFileResult<adblock::Engine>> results;
+    const size_t resident_before = GetResidentSetSize();
+    base::ElapsedTimer timer;
+    for (size_t i = 0; i < kNumEngines; ++i) {
+      results.push_back(LoadDATFile<adblock::Engine>(dat_file_path_, mode));
+      ASSERT_TRUE(results.back().first) << dat_file_path_;
+      ASSERT_EQ(mode == DATFileLoadMode::kMap,
+                results.back().second->is_mapped());
+    }
+    reporter.AddResult(kMetricLoadTime, timer.Elapsed());
+    // With the data still held, as when it's kept around to rebuild engines.
+    // Mapped pages are part of the resident set once they've been read, but
+    // unlike heap copies they're shared with the page cache and can be
+    // reclaimed.
+    reporter.AddResult(kMetricResidentSetDelta,
+                       GetResidentSetDelta(resident_before));
+
+    for (auto& result : results)
+      result.second = nullptr;
+    reporter.AddResult(kMetricResidentSetDeltaReleased,
+                       GetResidentSetDelta(resident_before));
+  }
+
+  base::FilePath dat_file_path_;
+};
+
+}  // namespace
+
+TEST_F(AdBlockDATFilePerfTest, Read) {
+  RunTest(DATFileLoadMode::kRead, "read");
+}
+
+TEST_F(AdBlockDATFilePerfTest, Map) {
+  RunTest(DATFileLoadMode::kMap, "map");
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,167 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_engine_snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "base/atomic_sequence_num.h"
+#include "base/logging.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "url/gurl.h"
+#include "url/origin.h"
+
+using net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES;
+using net::registry_controlled_domains::SameDomainOrHost;
+
+namespace brave_shields {
+
+namespace {
+
+std::string ResourceTypeToString(blink::mojom::ResourceType resource_type) {
+  std::string filter_option = "";
+  switch (resource_type) {
+    // top level page
+    case blink::mojom::ResourceType::kMainFrame:
+      filter_option = "main_frame";
+      break;
+    // frame or iframe
+    case blink::mojom::ResourceType::kSubFrame:
+      filter_option = "sub_frame";
+      break;
+    // a CSS stylesheet
+    case blink::mojom::ResourceType::kStylesheet:
+      filter_option = "stylesheet";
+      break;
+    // an external script
+    case blink::mojom::ResourceType::kScript:
+      filter_option = "script";
+      break;
+    // an image (jpg/gif/png/etc)
+    case blink::mojom::ResourceType::kFavicon:
+    case blink::mojom::ResourceType::kImage:
+      filter_option = "image";
+      break;
+    // a font
+    case blink::mojom::ResourceType::kFontResource:
+      filter_option = "font";
+      break;
+    // an "other" subresource.
+    case blink::mojom::ResourceType::kSubResource:
+      filter_option = "other";
+      break;
+    // an object (or embed) tag for a plugin.
+    case blink::mojom::ResourceType::kObject:
+      filter_option = "object";
+      break;
+    // a media resource.
+    case blink::mojom::ResourceType::kMedia:
+      filter_option = "media";
+      break;
+    // a XMLHttpRequest
+    case blink::mojom::ResourceType::kXhr:
+      filter_option = "xhr";
+      break;
+    // a ping request for <a ping>/sendBeacon.
+    case blink::mojom::ResourceType::kPing:
+      filter_option = "ping";
+      break;
+    // the main resource of a dedicated worker.
+    case blink::mojom::ResourceType::kWorker:
+    // the main resource of a shared worker.
+    case blink::mojom::ResourceType::kSharedWorker:
+    // an explicitly requested prefetch
+    case blink::mojom::ResourceType::kPrefetch:
+    // the main resource of a service worker.
+    case blink::mojom::ResourceType::kServiceWorker:
+    // a report of Content Security Policy violations.
+    case blink::mojom::ResourceType::kCspReport:
+    // a resource that a plugin requested.
+    case blink::mojom::ResourceType::kPluginResource:
+    default:
+      break;
+  }
+  return filter_option;
+}
+
+base::AtomicSequenceNumber g_snapshot_version;
+
+std::atomic<uint64_t> g_engine_generation{0};
+
+}  // namespace
+
+AdBlockEngineSnapshot::AdBlockEngineSnapshot(
+    std::unique_ptr<adblock::Engine> engine,
+    std::vector<std::string> tags)
+    : engine_(std::move(engine)),
+      tags_(std::move(tags)),
+      version_(static_cast<uint64_t>(g_snapshot_version.GetNext()) + 1) {
+  DCHECK(engine_);
+}
+
+AdBlockEngineSnapshot::~AdBlockEngineSnapshot() = default;
+
+void AdBlockEngineSnapshot::ShouldStartRequest(
+    const GURL& url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host,
+    bool* did_match_rule,
+    bool* did_match_exception,
+    bool* did_match_important,
+    std::string* mock_data_url) const {
+  // Determine third-party here so the library doesn't need to figure it out.
+  // CreateFromNormalizedTuple is needed because SameDomainOrHost needs
+  // a URL or origin and not a string to a host name.
+  bool is_third_party = !SameDomainOrHost(
+      url,
+      url::Origin::CreateFromNormalizedTuple("https", tab_host.c_str(), 80),
+      INCLUDE_PRIVATE_REGISTRIES);
+  Matches(url.spec(), url.host(), tab_host, is_third_party,
+          ResourceTypeToString(resource_type), did_match_rule,
+          did_match_exception, did_match_important, mock_data_url);
+}
+
+void AdBlockEngineSnapshot::Matches(const std::string& url,
+                                    const std::string& host,
+                                    const std::string& tab_host,
+                                    bool is_third_party,
+                                    const std::string& resource_type,
+                                    bool* did_match_rule,
+                                    bool* did_match_exception,
+                                    bool* did_match_important,
+                                    std::string* mock_data_url) const {
+  engine_->matches(url, host, tab_host, is_third_party, resource_type,
+                   did_match_rule, did_match_exception, did_match_important,
+                   mock_data_url);
+}
+
+std::string AdBlockEngineSnapshot::UrlCosmeticResources(
+    const std::string& url) const {
+  return engine_->urlCosmeticResources(url);
+}
+
+std::string AdBlockEngineSnapshot::HiddenClassIdSelectors(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) const {
+  return engine_->hiddenClassIdSelectors(classes, ids, exceptions);
+}
+
+bool AdBlockEngineSnapshot::TagExists(const std::string& tag) const {
+  return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
+}
+
+uint64_t GetAdBlockEngineGeneration() {
+  return g_engine_generation.load(std::memory_order_acquire);
+}
+
+void BumpAdBlockEngineGeneration() {
+  g_engine_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+}  // namespace brave_shields
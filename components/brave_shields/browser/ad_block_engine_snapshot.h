@@ -0,0 +1,84 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_SNAPSHOT_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
+
+class GURL;
+
+namespace adblock {
+class Engine;
+}
+
+namespace brave_shields {
+
+// An immutable, ref-counted adblock engine. A snapshot is fully configured
+// (tags and resources applied) before it is published and is never modified
+// afterwards, so any thread holding a reference may query it concurrently.
+// Configuration changes are made by building and publishing a new snapshot.
+class AdBlockEngineSnapshot
+    : public base::RefCountedThreadSafe<AdBlockEngineSnapshot> {
+ public:
+  AdBlockEngineSnapshot(std::unique_ptr<adblock::Engine> engine,
+                        std::vector<std::string> tags);
+
+  void ShouldStartRequest(const GURL& url,
+                          blink::mojom::ResourceType resource_type,
+                          const std::string& tab_host,
+                          bool* did_match_rule,
+                          bool* did_match_exception,
+                          bool* did_match_important,
+                          std::string* mock_data_url) const;
+  void Matches(const std::string& url,
+               const std::string& host,
+               const std::string& tab_host,
+               bool is_third_party,
+               const std::string& resource_type,
+               bool* did_match_rule,
+               bool* did_match_exception,
+               bool* did_match_important,
+               std::string* mock_data_url) const;
+  std::string UrlCosmeticResources(const std::string& url) const;
+  std::string HiddenClassIdSelectors(
+      const std::vector<std::string>& classes,
+      const std::vector<std::string>& ids,
+      const std::vector<std::string>& exceptions) const;
+  bool TagExists(const std::string& tag) const;
+
+  // Unique across all snapshots created by this process, increasing with
+  // every newly published snapshot.
+  uint64_t version() const { return version_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<AdBlockEngineSnapshot>;
+  ~AdBlockEngineSnapshot();
+
+  // Only the read-only parts of the engine API are used once constructed.
+  const std::unique_ptr<adblock::Engine> engine_;
+  const std::vector<std::string> tags_;
+  const uint64_t version_;
+
+  DISALLOW_COPY_AND_ASSIGN(AdBlockEngineSnapshot);
+};
+
+// Returns a process-wide generation of the engines used for matching. It is
+// bumped after every published snapshot and whenever an engine is added or
+// removed, and can be read on any thread without taking a lock.
+uint64_t GetAdBlockEngineGeneration();
+void BumpAdBlockEngineGeneration();
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_AD_BLOCK_ENGINE_SNAPSHOT_H_
@@ -14,6 +14,7 @@
 #include "base/values.h"
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/pref_names.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_snapshot.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
@@ -143,6 +144,14 @@ void AdBlockRegionalServiceManager::ShouldStartRequest(
   }
 }
 
+void AdBlockRegionalServiceManager::ShouldStartRequests(
+    AdBlockMatchRequests* requests) {
+  base::AutoLock lock(regional_services_lock_);
+  for (const auto& regional_service : regional_services_) {
+    regional_service.second->ShouldStartRequests(requests);
+  }
+}
+
 void AdBlockRegionalServiceManager::EnableTag(const std::string& tag,
                                               bool enabled) {
   base::AutoLock lock(regional_services_lock_);
@@ -182,6 +191,8 @@ void AdBlockRegionalServiceManager::EnableFilterList(
       it->second->Unregister();
       regional_services_.erase(it);
     }
+    // Requests are no longer matched against the same set of engines.
+    BumpAdBlockEngineGeneration();
   }
 
   // Update preferences to reflect enabled/disabled state of specified
@@ -196,16 +207,8 @@ base::Optional<base::Value>
 AdBlockRegionalServiceManager::UrlCosmeticResources(
         const std::string& url) {
   base::AutoLock lock(regional_services_lock_);
-  auto it = regional_services_.begin();
-  if (it == regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->UrlCosmeticResources(url);
-
-  for ( ; it != regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->UrlCosmeticResources(url);
+  base::Optional<base::Value> first_value;
+  auto merge = [&first_value](base::Optional<base::Value> next_value) {
     if (first_value) {
       if (next_value) {
         MergeResourcesInto(std::move(*next_value), &*first_value, false);
@@ -213,6 +216,10 @@ AdBlockRegionalServiceManager::UrlCosmeticResources(
     } else {
       first_value = std::move(next_value);
     }
+  };
+
+  for (const auto& regional_service : regional_services_) {
+    merge(regional_service.second->UrlCosmeticResources(url));
   }
 
   return first_value;
@@ -224,16 +231,8 @@ AdBlockRegionalServiceManager::HiddenClassIdSelectors(
         const std::vector<std::string>& ids,
         const std::vector<std::string>& exceptions) {
   base::AutoLock lock(regional_services_lock_);
-  auto it = regional_services_.begin();
-  if (it == regional_services_.end()) {
-    return base::Optional<base::Value>();
-  }
-  base::Optional<base::Value> first_value =
-      it->second->HiddenClassIdSelectors(classes, ids, exceptions);
-
-  for ( ; it != regional_services_.end(); it++) {
-    base::Optional<base::Value> next_value =
-        it->second->HiddenClassIdSelectors(classes, ids, exceptions);
+  base::Optional<base::Value> first_value;
+  auto merge = [&first_value](base::Optional<base::Value> next_value) {
     if (first_value && first_value->is_list()) {
       if (next_value && next_value->is_list()) {
         for (auto i = next_value->GetList().begin();
@@ -245,6 +244,11 @@ AdBlockRegionalServiceManager::HiddenClassIdSelectors(
     } else {
       first_value = std::move(next_value);
     }
+  };
+
+  for (const auto& regional_service : regional_services_) {
+    merge(regional_service.second->HiddenClassIdSelectors(classes, ids,
+                                                          exceptions));
   }
 
   return first_value;
@@ -17,6 +17,7 @@
 #include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
+#include "brave/components/brave_shields/browser/ad_block_base_service.h"
 #include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
 #include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
 #include "url/gurl.h"
@@ -25,7 +26,9 @@ namespace base {
 class ListValue;
 }  // namespace base
 
+class AdBlockRegionalServiceManagerTest;
 class AdBlockServiceTest;
+class AdBlockServiceUnitTest;
 
 using brave_component_updater::BraveComponent;
 
@@ -54,6 +57,9 @@ class AdBlockRegionalServiceManager {
                           bool* did_match_exception,
                           bool* did_match_important,
                           std::string* mock_data_url);
+  // Matches a whole batch of requests against every regional list while
+  // holding |regional_services_lock_| only once.
+  void ShouldStartRequests(AdBlockMatchRequests* requests);
   void EnableTag(const std::string& tag, bool enabled);
   void AddResources(const std::string& resources);
   void EnableFilterList(const std::string& uuid, bool enabled);
@@ -66,7 +72,9 @@ class AdBlockRegionalServiceManager {
           const std::vector<std::string>& exceptions);
 
  private:
+  friend class ::AdBlockRegionalServiceManagerTest;
   friend class ::AdBlockServiceTest;
+  friend class ::AdBlockServiceUnitTest;
   bool Init();
   void StartRegionalServices();
   void UpdateFilterListPrefs(const std::string& uuid, bool enabled);
@@ -0,0 +1,196 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "brave/components/brave_component_updater/browser/test_brave_component_delegate.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_snapshot.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
+#include "content/public/test/browser_task_environment.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+const char kTabHost[] = "example.com";
+
+void TestDomainResolver(const char* host, uint32_t* start, uint32_t* end) {
+  const std::string host_str(host);
+  const std::string domain =
+      net::registry_controlled_domains::GetDomainAndRegistry(
+          host_str,
+          net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  const size_t match = host_str.rfind(domain);
+  *start = match != std::string::npos ? match : 0;
+  *end = match != std::string::npos ? match + domain.length()
+                                    : host_str.length();
+}
+
+}  // namespace
+
+class AdBlockRegionalServiceManagerTest : public testing::Test {
+ public:
+  AdBlockRegionalServiceManagerTest()
+      : manager_(brave_shields::AdBlockRegionalServiceManagerFactory(
+            &component_delegate_)) {}
+  ~AdBlockRegionalServiceManagerTest() override = default;
+
+  void SetUp() override { adblock::SetDomainResolver(TestDomainResolver); }
+
+ protected:
+  // Adds an enabled regional list filtering with |rules|, bypassing the
+  // catalog, prefs and component registration.
+  brave_shields::AdBlockRegionalService* AddRegionalList(
+      const std::string& uuid,
+      const std::string& rules) {
+    adblock::FilterList catalog_entry(uuid, "https://brave.com", uuid, {},
+                                      "https://support.brave.com",
+                                      "componentid", "base64publickey",
+                                      "Filter list for testing purposes");
+    auto regional_service = brave_shields::AdBlockRegionalServiceFactory(
+        catalog_entry, &component_delegate_);
+    brave_shields::AdBlockRegionalService* result = regional_service.get();
+    result->ResetForTest(rules, std::string());
+    base::AutoLock lock(manager_->regional_services_lock_);
+    manager_->regional_services_.insert(
+        std::make_pair(uuid, std::move(regional_service)));
+    return result;
+  }
+
+  void SetRules(brave_shields::AdBlockRegionalService* regional_service,
+                const std::string& rules) {
+    regional_service->ResetForTest(rules, std::string());
+  }
+
+  // Removes a list the way EnableFilterList() does.
+  void RemoveRegionalList(const std::string& uuid) {
+    base::AutoLock lock(manager_->regional_services_lock_);
+    manager_->regional_services_.erase(uuid);
+    brave_shields::BumpAdBlockEngineGeneration();
+  }
+
+  brave_shields::AdBlockMatchRequest Match(const std::string& url) {
+    brave_shields::AdBlockMatchRequest request(
+        GURL(url), blink::mojom::ResourceType::kImage, kTabHost);
+    manager_->ShouldStartRequest(
+        request.url, request.resource_type, request.tab_host,
+        &request.did_match_rule, &request.did_match_exception,
+        &request.did_match_important, &request.mock_data_url);
+    return request;
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  brave_component_updater::TestBraveComponentDelegate component_delegate_;
+  std::unique_ptr<brave_shields::AdBlockRegionalServiceManager> manager_;
+};
+
+TEST_F(AdBlockRegionalServiceManagerTest, MatchesAcrossLists) {
+  AddRegionalList("list-a", "/banner_a.png");
+  AddRegionalList("list-b", "/banner_b.png\n@@/banner_a.png");
+
+  brave_shields::AdBlockMatchRequest a = Match("https://ads.com/banner_a.png");
+  EXPECT_TRUE(a.did_match_rule);
+  EXPECT_TRUE(a.did_match_exception);
+
+  brave_shields::AdBlockMatchRequest b = Match("https://ads.com/banner_b.png");
+  EXPECT_TRUE(b.did_match_rule);
+  EXPECT_FALSE(b.did_match_exception);
+
+  EXPECT_FALSE(Match("https://ads.com/banner_c.png").did_match_rule);
+}
+
+TEST_F(AdBlockRegionalServiceManagerTest, StopsAtImportantMatch) {
+  // Lists are consulted in uuid order, so the exception in the second list
+  // is never reached once the first one matched an important rule.
+  AddRegionalList("list-a", "/banner.png$important");
+  AddRegionalList("list-b", "@@/banner.png");
+
+  brave_shields::AdBlockMatchRequest request =
+      Match("https://ads.com/banner.png");
+  EXPECT_TRUE(request.did_match_rule);
+  EXPECT_TRUE(request.did_match_important);
+  EXPECT_FALSE(request.did_match_exception);
+}
+
+TEST_F(AdBlockRegionalServiceManagerTest, BatchedMatchesPerRequestMatches) {
+  AddRegionalList("list-a", "/banner.png$important\n/script.js");
+  AddRegionalList("list-b", "@@/banner.png\n@@/script.js\n/pixel.gif");
+
+  const std::vector<std::string> urls = {
+      "https://ads.com/banner.png", "https://ads.com/script.js",
+      "https://ads.com/pixel.gif", "https://ads.com/content.png"};
+  brave_shields::AdBlockMatchRequests requests;
+  for (const auto& url : urls) {
+    requests.emplace_back(GURL(url), blink::mojom::ResourceType::kImage,
+                          kTabHost);
+  }
+  manager_->ShouldStartRequests(&requests);
+
+  ASSERT_EQ(urls.size(), requests.size());
+  for (size_t i = 0; i < urls.size(); ++i) {
+    SCOPED_TRACE(urls[i]);
+    brave_shields::AdBlockMatchRequest expected = Match(urls[i]);
+    EXPECT_EQ(expected.did_match_rule, requests[i].did_match_rule);
+    EXPECT_EQ(expected.did_match_exception, requests[i].did_match_exception);
+    EXPECT_EQ(expected.did_match_important, requests[i].did_match_important);
+    EXPECT_EQ(expected.mock_data_url, requests[i].mock_data_url);
+  }
+}
+
+TEST_F(AdBlockRegionalServiceManagerTest, QueriesEachListOnceForCosmetics) {
+  AddRegionalList("list-a", "##.ad-banner\nexample.com##.local-ad");
+  AddRegionalList("list-b", "##.sponsored\nexample.com##.local-sponsored");
+
+  base::Optional<base::Value> selectors = manager_->HiddenClassIdSelectors(
+      {"ad-banner", "sponsored"}, {}, {});
+  ASSERT_TRUE(selectors && selectors->is_list());
+  EXPECT_EQ(2u, selectors->GetList().size());
+
+  base::Optional<base::Value> resources =
+      manager_->UrlCosmeticResources("https://example.com/");
+  ASSERT_TRUE(resources);
+  const base::Value* hide_selectors = resources->FindListKey("hide_selectors");
+  ASSERT_TRUE(hide_selectors);
+  EXPECT_EQ(2u, hide_selectors->GetList().size());
+}
+
+TEST_F(AdBlockRegionalServiceManagerTest, HasNoCosmeticsWithoutLists) {
+  EXPECT_FALSE(manager_->HiddenClassIdSelectors({"ad-banner"}, {}, {}));
+  EXPECT_FALSE(manager_->UrlCosmeticResources("https://example.com/"));
+}
+
+TEST_F(AdBlockRegionalServiceManagerTest, EngineGenerationTracksLists) {
+  const uint64_t empty_generation = brave_shields::GetAdBlockEngineGeneration();
+
+  brave_shields::AdBlockRegionalService* list_a =
+      AddRegionalList("list-a", "/banner.png");
+  const uint64_t one_list_generation =
+      brave_shields::GetAdBlockEngineGeneration();
+  EXPECT_NE(empty_generation, one_list_generation);
+  EXPECT_EQ(one_list_generation, brave_shields::GetAdBlockEngineGeneration());
+
+  // Replacing the rules of a list publishes a new engine for it.
+  SetRules(list_a, "/pixel.gif");
+  const uint64_t updated_generation =
+      brave_shields::GetAdBlockEngineGeneration();
+  EXPECT_NE(one_list_generation, updated_generation);
+  EXPECT_TRUE(Match("https://ads.com/pixel.gif").did_match_rule);
+  EXPECT_FALSE(Match("https://ads.com/banner.png").did_match_rule);
+
+  AddRegionalList("list-b", "/script.js");
+  const uint64_t two_lists_generation =
+      brave_shields::GetAdBlockEngineGeneration();
+  EXPECT_NE(updated_generation, two_lists_generation);
+
+  RemoveRegionalList("list-b");
+  EXPECT_NE(two_lists_generation, brave_shields::GetAdBlockEngineGeneration());
+}
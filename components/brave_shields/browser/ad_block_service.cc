@@ -20,6 +20,7 @@
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_engine_snapshot.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
 #include "brave/components/brave_shields/browser/ad_block_service_helper.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
@@ -100,6 +101,12 @@ void AdBlockService::ShouldStartRequest(
       did_match_important, mock_data_url);
 }
 
+void AdBlockService::ShouldStartRequests(AdBlockMatchRequests* requests) {
+  AdBlockBaseService::ShouldStartRequests(requests);
+  regional_service_manager()->ShouldStartRequests(requests);
+  custom_filters_service()->ShouldStartRequests(requests);
+}
+
 base::Optional<base::Value> AdBlockService::UrlCosmeticResources(
     const std::string& url) {
   base::Optional<base::Value> resources =
@@ -163,25 +170,30 @@ base::Optional<base::Value> AdBlockService::HiddenClassIdSelectors(
   return hide_selectors;
 }
 
+uint64_t AdBlockService::GetEngineVersion() {
+  return GetAdBlockEngineGeneration();
+}
+
 AdBlockRegionalServiceManager* AdBlockService::regional_service_manager() {
-  if (!regional_service_manager_)
-    regional_service_manager_ =
-        brave_shields::AdBlockRegionalServiceManagerFactory(
-            component_delegate_);
   return regional_service_manager_.get();
 }
 
 brave_shields::AdBlockCustomFiltersService*
 AdBlockService::custom_filters_service() {
-  if (!custom_filters_service_)
-    custom_filters_service_ =
-        brave_shields::AdBlockCustomFiltersServiceFactory(component_delegate_);
   return custom_filters_service_.get();
 }
 
 AdBlockService::AdBlockService(
     brave_component_updater::BraveComponent::Delegate* delegate)
-    : AdBlockBaseService(delegate), component_delegate_(delegate) {}
+    : AdBlockBaseService(delegate), component_delegate_(delegate) {
+  // Created up front rather than on first use: requests are matched on the
+  // thread pool, and lazily creating these there would race with the UI
+  // thread.
+  regional_service_manager_ =
+      brave_shields::AdBlockRegionalServiceManagerFactory(component_delegate_);
+  custom_filters_service_ =
+      brave_shields::AdBlockCustomFiltersServiceFactory(component_delegate_);
+}
 
 AdBlockService::~AdBlockService() {}
 
@@ -55,6 +55,7 @@ class AdBlockService : public AdBlockBaseService {
                           bool* did_match_exception,
                           bool* did_match_important,
                           std::string* mock_data_url) override;
+  void ShouldStartRequests(AdBlockMatchRequests* requests) override;
   base::Optional<base::Value> UrlCosmeticResources(
       const std::string& url) override;
   base::Optional<base::Value> HiddenClassIdSelectors(
@@ -62,6 +63,12 @@ class AdBlockService : public AdBlockBaseService {
       const std::vector<std::string>& ids,
       const std::vector<std::string>& exceptions) override;
 
+  // Returns a value identifying the engines currently used for matching. It
+  // changes whenever a list, tag or resource update publishes a new engine
+  // in the default, regional or custom filters services. Lock-free, so it's
+  // cheap to read once per request.
+  uint64_t GetEngineVersion();
+
   AdBlockRegionalServiceManager* regional_service_manager();
   AdBlockCustomFiltersService* custom_filters_service();
 
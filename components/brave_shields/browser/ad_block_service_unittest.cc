@@ -0,0 +1,189 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/ad_block_service.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "brave/components/brave_component_updater/browser/test_brave_component_delegate.h"
+#include "brave/components/brave_shields/browser/ad_block_custom_filters_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service.h"
+#include "brave/components/brave_shields/browser/ad_block_regional_service_manager.h"
+#include "brave/vendor/adblock_rust_ffi/src/wrapper.h"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+const char kTabHost[] = "example.com";
+
+const char kNoopJsResources[] = R"([{
+    "name": "noop.js",
+    "aliases": ["noopjs"],
+    "kind": {"mime": "application/javascript"},
+    "content": "KGZ1bmN0aW9uKCkgewogICAgJ3VzZSBzdHJpY3QnOwp9KSgpOwo="
+  }])";
+
+struct TestRequest {
+  const char* url;
+  blink::mojom::ResourceType resource_type;
+};
+
+}  // namespace
+
+class AdBlockServiceUnitTest : public testing::Test {
+ public:
+  AdBlockServiceUnitTest()
+      : service_(
+            brave_shields::AdBlockServiceFactory(&component_delegate_)) {}
+  ~AdBlockServiceUnitTest() override = default;
+
+  void SetUp() override {
+    // Starting the service installs the domain resolver used by the engines.
+    service_->Start();
+    task_environment_.RunUntilIdle();
+  }
+
+ protected:
+  void SetDefaultRules(const std::string& rules) {
+    service_->ResetForTest(rules, kNoopJsResources);
+  }
+
+  void AddRegionalList(const std::string& uuid, const std::string& rules) {
+    adblock::FilterList catalog_entry(uuid, "https://brave.com", uuid, {},
+                                      "https://support.brave.com",
+                                      "componentid", "base64publickey",
+                                      "Filter list for testing purposes");
+    auto regional_service = brave_shields::AdBlockRegionalServiceFactory(
+        catalog_entry, &component_delegate_);
+    regional_service->ResetForTest(rules, std::string());
+    brave_shields::AdBlockRegionalServiceManager* manager =
+        service_->regional_service_manager();
+    base::AutoLock lock(manager->regional_services_lock_);
+    manager->regional_services_.insert(
+        std::make_pair(uuid, std::move(regional_service)));
+  }
+
+  void SetCustomRules(const std::string& rules) {
+    service_->custom_filters_service()->ResetForTest(rules, std::string());
+  }
+
+  brave_shields::AdBlockMatchRequest Match(const TestRequest& test_request) {
+    brave_shields::AdBlockMatchRequest request(
+        GURL(test_request.url), test_request.resource_type, kTabHost);
+    service_->ShouldStartRequest(
+        request.url, request.resource_type, request.tab_host,
+        &request.did_match_rule, &request.did_match_exception,
+        &request.did_match_important, &request.mock_data_url);
+    return request;
+  }
+
+  // Checks that matching |test_requests| as one batch gives the same results
+  // as matching them one by one.
+  void ExpectBatchMatchesPerRequest(
+      const std::vector<TestRequest>& test_requests) {
+    brave_shields::AdBlockMatchRequests requests;
+    for (const auto& test_request : test_requests) {
+      requests.emplace_back(GURL(test_request.url),
+                            test_request.resource_type, kTabHost);
+    }
+    service_->ShouldStartRequests(&requests);
+
+    ASSERT_EQ(test_requests.size(), requests.size());
+    for (size_t i = 0; i < test_requests.size(); ++i) {
+      SCOPED_TRACE(test_requests[i].url);
+      const brave_shields::AdBlockMatchRequest expected =
+          Match(test_requests[i]);
+      EXPECT_EQ(expected.did_match_rule, requests[i].did_match_rule);
+      EXPECT_EQ(expected.did_match_exception,
+                requests[i].did_match_exception);
+      EXPECT_EQ(expected.did_match_important,
+                requests[i].did_match_important);
+      EXPECT_EQ(expected.mock_data_url, requests[i].mock_data_url);
+    }
+  }
+
+  content::BrowserTaskEnvironment task_environment_;
+  brave_component_updater::TestBraveComponentDelegate component_delegate_;
+  std::unique_ptr<brave_shields::AdBlockService> service_;
+};
+
+TEST_F(AdBlockServiceUnitTest, BatchMatchesPerRequestWithoutLists) {
+  ExpectBatchMatchesPerRequest({
+      {"https://ads.com/banner.png", blink::mojom::ResourceType::kImage},
+      {"https://example.com/script.js", blink::mojom::ResourceType::kScript},
+  });
+}
+
+TEST_F(AdBlockServiceUnitTest, BatchMatchesPerRequestAcrossEngines) {
+  SetDefaultRules(
+      "/default_block.png\n"
+      "/important.png$important\n"
+      "js_mock_me.js$redirect=noopjs\n"
+      "@@/custom_block.png");
+  AddRegionalList("regional-a",
+                  "/regional_block.png\n"
+                  "@@/default_block.png\n"
+                  "/regional_important.png$important");
+  AddRegionalList("regional-b",
+                  "@@/regional_important.png\n"
+                  "/third_party.gif$third-party");
+  SetCustomRules(
+      "/custom_block.png\n"
+      "@@/important.png\n"
+      "@@/regional_block.png\n"
+      "/script_only.js$script");
+
+  ExpectBatchMatchesPerRequest({
+      // Blocked by the default engine and excepted by a regional list.
+      {"https://ads.com/default_block.png", blink::mojom::ResourceType::kImage},
+      // Important default match: regional and custom exceptions are skipped.
+      {"https://ads.com/important.png", blink::mojom::ResourceType::kImage},
+      // Important regional match stops before the second regional list.
+      {"https://ads.com/regional_important.png",
+       blink::mojom::ResourceType::kImage},
+      // Regional block with a custom exception.
+      {"https://ads.com/regional_block.png",
+       blink::mojom::ResourceType::kImage},
+      // Custom block with a default exception.
+      {"https://ads.com/custom_block.png", blink::mojom::ResourceType::kImage},
+      // Redirect resource from the default engine.
+      {"https://ads.com/js_mock_me.js", blink::mojom::ResourceType::kScript},
+      // Options depending on the request: party and resource type.
+      {"https://ads.com/third_party.gif", blink::mojom::ResourceType::kImage},
+      {"https://example.com/third_party.gif",
+       blink::mojom::ResourceType::kImage},
+      {"https://ads.com/script_only.js", blink::mojom::ResourceType::kScript},
+      {"https://ads.com/script_only.js", blink::mojom::ResourceType::kImage},
+      // Not matched by any engine.
+      {"https://example.com/content.png", blink::mojom::ResourceType::kImage},
+  });
+}
+
+TEST_F(AdBlockServiceUnitTest, BatchStopsAtImportantMatch) {
+  SetDefaultRules("/important.png$important");
+  AddRegionalList("regional-a", "@@/important.png\n/regional_block.png");
+  SetCustomRules("@@/important.png");
+
+  brave_shields::AdBlockMatchRequests requests;
+  requests.emplace_back(GURL("https://ads.com/important.png"),
+                        blink::mojom::ResourceType::kImage, kTabHost);
+  requests.emplace_back(GURL("https://ads.com/regional_block.png"),
+                        blink::mojom::ResourceType::kImage, kTabHost);
+  service_->ShouldStartRequests(&requests);
+
+  EXPECT_TRUE(requests[0].did_match_rule);
+  EXPECT_TRUE(requests[0].did_match_important);
+  EXPECT_FALSE(requests[0].did_match_exception);
+
+  // Other requests of the batch still go through every engine.
+  EXPECT_TRUE(requests[1].did_match_rule);
+  EXPECT_FALSE(requests[1].did_match_important);
+  EXPECT_FALSE(requests[1].did_match_exception);
+}
@@ -11,6 +11,8 @@
 #include <utility>
 #include <vector>
 
+#include "base/bind.h"
+#include "base/stl_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/common/pref_names.h"
 #include "brave/common/render_messages.h"
@@ -53,6 +55,8 @@ using content::WebContents;
 
 namespace {
 
+base::TimeDelta g_stats_flush_delay = base::TimeDelta::FromSeconds(5);
+
 // Content Settings are only sent to the main frame currently.
 // Chrome may fix this at some point, but for now we do this as a work-around.
 // You can verify if this is fixed by running the following test:
@@ -212,7 +216,7 @@ GURL BraveShieldsWebContentsObserver::GetTabURLFromRenderFrameInfo(
 
 bool BraveShieldsWebContentsObserver::IsBlockedSubresource(
     const std::string& subresource) {
-  return blocked_url_paths_.find(subresource) != blocked_url_paths_.end();
+  return base::Contains(blocked_url_paths_, subresource);
 }
 
 void BraveShieldsWebContentsObserver::AddBlockedSubresource(
@@ -220,6 +224,12 @@ void BraveShieldsWebContentsObserver::AddBlockedSubresource(
   blocked_url_paths_.insert(subresource);
 }
 
+// static
+void BraveShieldsWebContentsObserver::SetStatsFlushDelayForTesting(
+    base::TimeDelta delay) {
+  g_stats_flush_delay = delay;
+}
+
 // static
 void BraveShieldsWebContentsObserver::DispatchBlockedEvent(
     std::string block_type,
@@ -231,34 +241,59 @@ void BraveShieldsWebContentsObserver::DispatchBlockedEvent(
 
   WebContents* web_contents = GetWebContents(render_process_id,
     render_frame_id, frame_tree_node_id);
+  BraveShieldsWebContentsObserver* observer =
+      web_contents ? BraveShieldsWebContentsObserver::FromWebContents(
+                         web_contents)
+                   : nullptr;
+
   DispatchBlockedEventForWebContents(block_type, subresource, web_contents);
 
-  if (web_contents) {
-    BraveShieldsWebContentsObserver* observer =
-        BraveShieldsWebContentsObserver::FromWebContents(web_contents);
-    if (observer &&
-        !observer->IsBlockedSubresource(subresource)) {
-      observer->AddBlockedSubresource(subresource);
-      PrefService* prefs = Profile::FromBrowserContext(
-          web_contents->GetBrowserContext())->
-          GetOriginalProfile()->
-          GetPrefs();
-
-      if (block_type == kAds) {
-        prefs->SetUint64(kAdsBlocked, prefs->GetUint64(kAdsBlocked) + 1);
-      } else if (block_type == kHTTPUpgradableResources) {
-        prefs->SetUint64(kHttpsUpgrades, prefs->GetUint64(kHttpsUpgrades) + 1);
-      } else if (block_type == kJavaScript) {
-        prefs->SetUint64(kJavascriptBlocked,
-            prefs->GetUint64(kJavascriptBlocked) + 1);
-      } else if (block_type == kFingerprintingV2) {
-        prefs->SetUint64(kFingerprintingBlocked,
-            prefs->GetUint64(kFingerprintingBlocked) + 1);
-      }
-    }
+  if (!observer || !observer->blocked_url_paths_.insert(subresource).second)
+    return;
+
+  if (block_type == kAds) {
+    observer->IncrementStat(kAdsBlocked);
+  } else if (block_type == kHTTPUpgradableResources) {
+    observer->IncrementStat(kHttpsUpgrades);
+  } else if (block_type == kJavaScript) {
+    observer->IncrementStat(kJavascriptBlocked);
+  } else if (block_type == kFingerprintingV2) {
+    observer->IncrementStat(kFingerprintingBlocked);
+  }
+}
+
+void BraveShieldsWebContentsObserver::IncrementStat(
+    const std::string& pref_name) {
+  pending_stats_[pref_name]++;
+  if (g_stats_flush_delay.is_zero()) {
+    FlushStats();
+    return;
+  }
+  if (!stats_timer_.IsRunning()) {
+    stats_timer_.Start(
+        FROM_HERE, g_stats_flush_delay,
+        base::BindOnce(&BraveShieldsWebContentsObserver::FlushStats,
+                       base::Unretained(this)));
   }
 }
 
+void BraveShieldsWebContentsObserver::FlushStats() {
+  stats_timer_.Stop();
+  if (pending_stats_.empty())
+    return;
+  PrefService* prefs = Profile::FromBrowserContext(
+      web_contents()->GetBrowserContext())->
+      GetOriginalProfile()->
+      GetPrefs();
+  for (const auto& stat : pending_stats_)
+    prefs->SetUint64(stat.first, prefs->GetUint64(stat.first) + stat.second);
+  pending_stats_.clear();
+}
+
+void BraveShieldsWebContentsObserver::WebContentsDestroyed() {
+  FlushStats();
+}
+
 #if !defined(OS_ANDROID)
 // static
 void BraveShieldsWebContentsObserver::DispatchBlockedEventForWebContents(
@@ -306,25 +341,15 @@ bool BraveShieldsWebContentsObserver::OnMessageReceived(
 void BraveShieldsWebContentsObserver::OnJavaScriptBlockedWithDetail(
     RenderFrameHost* render_frame_host,
     const base::string16& details) {
-  WebContents* web_contents =
-      WebContents::FromRenderFrameHost(render_frame_host);
-  if (!web_contents) {
-    return;
-  }
   DispatchBlockedEventForWebContents(brave_shields::kJavaScript,
-      base::UTF16ToUTF8(details), web_contents);
+      base::UTF16ToUTF8(details), web_contents());
 }
 
 void BraveShieldsWebContentsObserver::OnFingerprintingBlockedWithDetail(
     RenderFrameHost* render_frame_host,
     const base::string16& details) {
-  WebContents* web_contents =
-      WebContents::FromRenderFrameHost(render_frame_host);
-  if (!web_contents) {
-    return;
-  }
   DispatchBlockedEventForWebContents(brave_shields::kFingerprintingV2,
-      base::UTF16ToUTF8(details), web_contents);
+      base::UTF16ToUTF8(details), web_contents());
 }
 
 // static
@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/cname_cache.h"
+
+namespace brave_shields {
+
+CnameCache::CnameCache() : entries_(kMaxEntries) {}
+
+CnameCache::~CnameCache() = default;
+
+bool CnameCache::Get(const net::NetworkIsolationKey& network_isolation_key,
+                     const std::string& host,
+                     std::string* canonical_name) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  auto it = entries_.Get(Key(network_isolation_key, host));
+  if (it == entries_.end())
+    return false;
+  if (it->second.expiration <= base::TimeTicks::Now()) {
+    entries_.Erase(it);
+    return false;
+  }
+  *canonical_name = it->second.canonical_name;
+  return true;
+}
+
+bool CnameCache::AddPendingResolve(
+    const net::NetworkIsolationKey& network_isolation_key,
+    const std::string& host,
+    ResolveCallback callback) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  auto& callbacks = pending_[Key(network_isolation_key, host)];
+  callbacks.push_back(std::move(callback));
+  return callbacks.size() == 1;
+}
+
+void CnameCache::OnResolveComplete(
+    const net::NetworkIsolationKey& network_isolation_key,
+    const std::string& host,
+    const base::Optional<std::string>& canonical_name) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  const Key key(network_isolation_key, host);
+  if (canonical_name) {
+    entries_.Put(
+        key, Entry{*canonical_name,
+                   base::TimeTicks::Now() +
+                       base::TimeDelta::FromSeconds(kEntryLifetimeSeconds)});
+  }
+
+  auto it = pending_.find(key);
+  if (it == pending_.end())
+    return;
+  // Callbacks may queue new resolves, so take them out first.
+  std::vector<ResolveCallback> callbacks = std::move(it->second);
+  pending_.erase(it);
+  for (auto& callback : callbacks)
+    std::move(callback).Run(canonical_name);
+}
+
+base::WeakPtr<CnameCache> CnameCache::AsWeakPtr() {
+  return weak_factory_.GetWeakPtr();
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,80 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_CNAME_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_CNAME_CACHE_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+#include "net/base/network_isolation_key.h"
+
+namespace brave_shields {
+
+// Canonical names of hosts resolved for CNAME uncloaking, partitioned by
+// NetworkIsolationKey like the host resolver cache itself.
+//
+// Only successful resolutions are kept. Callers that miss the cache register
+// with AddPendingResolve(), and only the first one for a given host starts a
+// resolve; everyone else is answered when it completes.
+class CnameCache {
+ public:
+  using ResolveCallback =
+      base::OnceCallback<void(const base::Optional<std::string>&)>;
+
+  static constexpr size_t kMaxEntries = 1024;
+  // The resolver doesn't report record TTLs, so use a conservative lifetime
+  // that is shorter than what trackers typically publish.
+  static constexpr int kEntryLifetimeSeconds = 60;
+
+  CnameCache();
+  ~CnameCache();
+
+  // Returns true and sets |canonical_name| if |host| was resolved recently.
+  bool Get(const net::NetworkIsolationKey& network_isolation_key,
+           const std::string& host,
+           std::string* canonical_name);
+
+  // Queues |callback| for the next resolve of |host|. Returns true if the
+  // caller is the first in line and has to start the resolve.
+  bool AddPendingResolve(const net::NetworkIsolationKey& network_isolation_key,
+                         const std::string& host,
+                         ResolveCallback callback);
+
+  // Stores |canonical_name| if set and runs all queued callbacks for |host|.
+  void OnResolveComplete(const net::NetworkIsolationKey& network_isolation_key,
+                         const std::string& host,
+                         const base::Optional<std::string>& canonical_name);
+
+  base::WeakPtr<CnameCache> AsWeakPtr();
+
+ private:
+  using Key = std::pair<net::NetworkIsolationKey, std::string>;
+
+  struct Entry {
+    std::string canonical_name;
+    base::TimeTicks expiration;
+  };
+
+  base::MRUCache<Key, Entry> entries_;
+  std::map<Key, std::vector<ResolveCallback>> pending_;
+
+  THREAD_CHECKER(thread_checker_);
+  base::WeakPtrFactory<CnameCache> weak_factory_{this};
+  DISALLOW_COPY_AND_ASSIGN(CnameCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_CNAME_CACHE_H_
@@ -0,0 +1,70 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/cname_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/origin.h"
+
+namespace brave_shields {
+
+class CnameCacheTest : public testing::Test {
+ protected:
+  base::test::TaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+  CnameCache cache_;
+};
+
+TEST_F(CnameCacheTest, ResolvesAreShared) {
+  const net::NetworkIsolationKey key;
+  std::vector<base::Optional<std::string>> results;
+  auto callback = base::BindRepeating(
+      [](std::vector<base::Optional<std::string>>* results,
+         const base::Optional<std::string>& canonical_name) {
+        results->push_back(canonical_name);
+      },
+      &results);
+
+  EXPECT_TRUE(cache_.AddPendingResolve(key, "a.brave.com", callback));
+  EXPECT_FALSE(cache_.AddPendingResolve(key, "a.brave.com", callback));
+  EXPECT_TRUE(cache_.AddPendingResolve(key, "b.brave.com", callback));
+
+  cache_.OnResolveComplete(key, "a.brave.com", std::string("tracker.com"));
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ("tracker.com", *results[0]);
+  EXPECT_EQ("tracker.com", *results[1]);
+
+  // Failures are reported but not cached.
+  cache_.OnResolveComplete(key, "b.brave.com", base::nullopt);
+  ASSERT_EQ(3u, results.size());
+  EXPECT_FALSE(results[2]);
+
+  std::string canonical_name;
+  EXPECT_TRUE(cache_.Get(key, "a.brave.com", &canonical_name));
+  EXPECT_EQ("tracker.com", canonical_name);
+  EXPECT_FALSE(cache_.Get(key, "b.brave.com", &canonical_name));
+}
+
+TEST_F(CnameCacheTest, PartitionedAndExpiring) {
+  const net::NetworkIsolationKey key;
+  const auto origin = url::Origin::Create(GURL("https://brave.com"));
+  const net::NetworkIsolationKey other_key(origin, origin);
+  cache_.OnResolveComplete(key, "a.brave.com", std::string("tracker.com"));
+
+  std::string canonical_name;
+  EXPECT_FALSE(cache_.Get(other_key, "a.brave.com", &canonical_name));
+  EXPECT_TRUE(cache_.Get(key, "a.brave.com", &canonical_name));
+
+  task_environment_.FastForwardBy(
+      base::TimeDelta::FromSeconds(CnameCache::kEntryLifetimeSeconds));
+  EXPECT_FALSE(cache_.Get(key, "a.brave.com", &canonical_name));
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,60 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_host_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+namespace brave_shields {
+
+HTTPSEHostCache::Shard::Shard(size_t capacity) : entries(capacity) {}
+
+HTTPSEHostCache::Shard::~Shard() = default;
+
+HTTPSEHostCache::HTTPSEHostCache(size_t capacity) {
+  const size_t shard_capacity =
+      std::max<size_t>(1, (capacity + kNumShards - 1) / kNumShards);
+  for (size_t i = 0; i < kNumShards; ++i)
+    shards_.push_back(std::make_unique<Shard>(shard_capacity));
+}
+
+HTTPSEHostCache::~HTTPSEHostCache() = default;
+
+bool HTTPSEHostCache::Get(const std::string& host,
+                          HTTPSEHostRulesets* rulesets) {
+  Shard* shard = GetShard(host);
+  base::AutoLock lock(shard->lock);
+  auto it = shard->entries.Get(host);
+  if (it == shard->entries.end()) {
+    misses_++;
+    return false;
+  }
+  hits_++;
+  *rulesets = it->second;
+  return true;
+}
+
+void HTTPSEHostCache::Put(const std::string& host,
+                          const HTTPSEHostRulesets& rulesets) {
+  Shard* shard = GetShard(host);
+  base::AutoLock lock(shard->lock);
+  shard->entries.Put(host, rulesets);
+}
+
+void HTTPSEHostCache::Clear() {
+  for (auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    shard->entries.Clear();
+  }
+}
+
+HTTPSEHostCache::Shard* HTTPSEHostCache::GetShard(const std::string& host) {
+  return shards_[std::hash<std::string>()(host) % kNumShards].get();
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,71 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_HOST_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_HOST_CACHE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/synchronization/lock.h"
+
+namespace brave_shields {
+
+class HTTPSERuleset;
+
+// The compiled rulesets that apply to a host, in lookup order. Empty for hosts
+// that have no rulesets, which is most of them.
+using HTTPSEHostRulesets = std::vector<scoped_refptr<const HTTPSERuleset>>;
+
+// Caches which HTTPS Everywhere rulesets apply to each host. Rules can depend
+// on the whole URL, so the rulesets are cached rather than rewritten URLs;
+// applying them is cheap once they're compiled, and every URL on a host
+// shares one entry. The cache is split into independently locked shards so
+// the UI thread and the HTTPSE task runner rarely contend.
+class HTTPSEHostCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 4096;
+  static constexpr size_t kNumShards = 16;
+
+  explicit HTTPSEHostCache(size_t capacity = kDefaultCapacity);
+  ~HTTPSEHostCache();
+
+  // Returns true and sets |rulesets| if |host| is cached. Counts towards
+  // hits() or misses().
+  bool Get(const std::string& host, HTTPSEHostRulesets* rulesets);
+  void Put(const std::string& host, const HTTPSEHostRulesets& rulesets);
+  void Clear();
+
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  struct Shard {
+    explicit Shard(size_t capacity);
+    ~Shard();
+
+    base::Lock lock;
+    base::MRUCache<std::string, HTTPSEHostRulesets> entries;
+  };
+
+  Shard* GetShard(const std::string& host);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSEHostCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_HOST_CACHE_H_
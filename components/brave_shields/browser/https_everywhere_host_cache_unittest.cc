@@ -0,0 +1,56 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_host_cache.h"
+
+#include <string>
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+TEST(HTTPSEHostCacheTest, Operations) {
+  HTTPSEHostCache cache;
+  HTTPSEHostRulesets rulesets;
+  EXPECT_FALSE(cache.Get("example.com", &rulesets));
+
+  scoped_refptr<HTTPSERuleset> ruleset =
+      HTTPSERuleset::Parse(R"([{"r": [{"d": 1}]}])");
+  ASSERT_TRUE(ruleset);
+  cache.Put("example.com", {ruleset});
+  // Hosts without rulesets are cached too.
+  cache.Put("example.org", {});
+
+  ASSERT_TRUE(cache.Get("example.com", &rulesets));
+  ASSERT_EQ(1u, rulesets.size());
+  EXPECT_EQ(ruleset.get(), rulesets[0].get());
+  ASSERT_TRUE(cache.Get("example.org", &rulesets));
+  EXPECT_TRUE(rulesets.empty());
+
+  EXPECT_EQ(2u, cache.hits());
+  EXPECT_EQ(1u, cache.misses());
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Get("example.com", &rulesets));
+}
+
+TEST(HTTPSEHostCacheTest, Eviction) {
+  // One entry per shard.
+  HTTPSEHostCache cache(HTTPSEHostCache::kNumShards);
+  for (int i = 0; i < 1000; ++i)
+    cache.Put("host" + std::to_string(i) + ".com", {});
+
+  size_t cached = 0;
+  HTTPSEHostRulesets rulesets;
+  for (int i = 0; i < 1000; ++i) {
+    if (cache.Get("host" + std::to_string(i) + ".com", &rulesets))
+      cached++;
+  }
+  EXPECT_LE(cached, HTTPSEHostCache::kNumShards);
+  EXPECT_TRUE(cache.Get("host999.com", &rulesets));
+}
+
+}  // namespace brave_shields
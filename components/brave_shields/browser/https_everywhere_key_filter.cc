@@ -0,0 +1,74 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_key_filter.h"
+
+#include <algorithm>
+
+#include "base/containers/span.h"
+#include "base/hash/hash.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+#include "third_party/leveldatabase/src/include/leveldb/iterator.h"
+
+namespace brave_shields {
+
+namespace {
+
+// Two independent hashes, combined with double hashing to derive the rest.
+void HashKey(const std::string& key, uint64_t* h1, uint64_t* h2) {
+  *h1 = base::PersistentHash(key);
+  *h2 = base::FastHash(base::as_bytes(base::make_span(key))) | 1;
+}
+
+}  // namespace
+
+HTTPSEKeyFilter::HTTPSEKeyFilter(size_t expected_keys)
+    : num_bits_(std::max<uint64_t>(64, expected_keys * kBitsPerKey)) {
+  bits_.resize((num_bits_ + 63) / 64);
+}
+
+HTTPSEKeyFilter::~HTTPSEKeyFilter() = default;
+
+// static
+std::unique_ptr<HTTPSEKeyFilter> HTTPSEKeyFilter::BuildFromDB(
+    leveldb::DB* db) {
+  if (!db)
+    return nullptr;
+
+  std::vector<std::string> keys;
+  std::unique_ptr<leveldb::Iterator> it(
+      db->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next())
+    keys.push_back(it->key().ToString());
+  if (!it->status().ok())
+    return nullptr;
+
+  auto filter = std::make_unique<HTTPSEKeyFilter>(keys.size());
+  for (const auto& key : keys)
+    filter->Add(key);
+  return filter;
+}
+
+void HTTPSEKeyFilter::Add(const std::string& key) {
+  uint64_t h1, h2;
+  HashKey(key, &h1, &h2);
+  for (size_t i = 0; i < kNumHashes; ++i) {
+    const uint64_t bit = (h1 + i * h2) % num_bits_;
+    bits_[bit / 64] |= uint64_t{1} << (bit % 64);
+  }
+}
+
+bool HTTPSEKeyFilter::MayContain(const std::string& key) const {
+  uint64_t h1, h2;
+  HashKey(key, &h1, &h2);
+  for (size_t i = 0; i < kNumHashes; ++i) {
+    const uint64_t bit = (h1 + i * h2) % num_bits_;
+    if (!(bits_[bit / 64] & (uint64_t{1} << (bit % 64))))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,52 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_KEY_FILTER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_KEY_FILTER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace leveldb {
+class DB;
+}
+
+namespace brave_shields {
+
+// A bloom filter over the keys of the HTTPS Everywhere DB ("com.foo",
+// "com.foo.*", ...). Nearly every host has no ruleset, and the filter lets
+// those lookups skip leveldb entirely. False positives just cost the leveldb
+// Get that would have happened anyway.
+class HTTPSEKeyFilter {
+ public:
+  // ~1% false positives.
+  static constexpr size_t kBitsPerKey = 10;
+  static constexpr size_t kNumHashes = 7;
+
+  explicit HTTPSEKeyFilter(size_t expected_keys);
+  ~HTTPSEKeyFilter();
+
+  // Returns a filter holding every key in |db|, or null if |db| couldn't be
+  // read.
+  static std::unique_ptr<HTTPSEKeyFilter> BuildFromDB(leveldb::DB* db);
+
+  void Add(const std::string& key);
+  bool MayContain(const std::string& key) const;
+
+ private:
+  std::vector<uint64_t> bits_;
+  uint64_t num_bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSEKeyFilter);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_KEY_FILTER_H_
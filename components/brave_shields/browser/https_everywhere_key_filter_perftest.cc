@@ -0,0 +1,122 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_key_filter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+
+namespace brave_shields {
+
+namespace {
+
+// Roughly the number of keys in the HTTPS Everywhere DB.
+constexpr int kNumKeys = 25000;
+constexpr int kNumLookups = 50000;
+// Share of looked up hosts that have a ruleset.
+constexpr int kPercentWithRuleset = 5;
+
+constexpr char kMetricPrefix[] = "HTTPSEKeyFilter.";
+constexpr char kMetricLookupsPerSecond[] = "lookups_per_second";
+constexpr char kMetricLeveldbGets[] = "leveldb_gets";
+
+// Same key scheme as the DB: reversed labels, with ".*" for wildcards.
+std::vector<std::string> ExpandHost(const std::string& host) {
+  std::vector<std::string> parts = base::SplitString(
+      host, ".", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  std::vector<std::string> keys;
+  std::string reversed;
+  for (size_t i = parts.size(); i > 0; --i) {
+    reversed += (reversed.empty() ? "" : ".") + parts[i - 1];
+    if (i != parts.size())
+      keys.push_back(i == 1 ? reversed : reversed + ".*");
+  }
+  return keys;
+}
+
+class HTTPSEKeyFilterPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    leveldb::Options options;
+    options.create_if_missing = true;
+    leveldb::DB* db = nullptr;
+    ASSERT_TRUE(leveldb::DB::Open(options,
+                                  temp_dir_.GetPath().AsUTF8Unsafe(), &db)
+                    .ok());
+    db_.reset(db);
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_TRUE(db_->Put(leveldb::WriteOptions(),
+                           base::StringPrintf("com.site%d", i),
+                           R"([{"r": [{"d": 1}]}])")
+                      .ok());
+    }
+
+    for (int i = 0; i < kNumLookups; ++i) {
+      if (i % 100 < kPercentWithRuleset) {
+        hosts_.push_back(base::StringPrintf("site%d.com", i % kNumKeys));
+      } else {
+        hosts_.push_back(
+            base::StringPrintf("cdn%d.tracker%d.net", i % 7, i % 5000));
+      }
+    }
+  }
+
+  void RunTest(const HTTPSEKeyFilter* filter, const std::string& story) {
+    size_t gets = 0;
+    size_t found = 0;
+    std::string value;
+    base::ElapsedTimer timer;
+    for (const auto& host : hosts_) {
+      for (const auto& key : ExpandHost(host)) {
+        if (filter && !filter->MayContain(key))
+          continue;
+        gets++;
+        if (db_->Get(leveldb::ReadOptions(), key, &value).ok()) {
+          found++;
+          break;
+        }
+      }
+    }
+    base::TimeDelta elapsed = timer.Elapsed();
+    EXPECT_EQ(static_cast<size_t>(kNumLookups * kPercentWithRuleset / 100),
+              found);
+
+    perf_test::PerfResultReporter reporter(kMetricPrefix, story);
+    reporter.RegisterImportantMetric(kMetricLookupsPerSecond, "runs/s");
+    reporter.RegisterImportantMetric(kMetricLeveldbGets, "count");
+    reporter.AddResult(kMetricLookupsPerSecond,
+                       static_cast<size_t>(kNumLookups / elapsed.InSecondsF()));
+    reporter.AddResult(kMetricLeveldbGets, gets);
+  }
+
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<leveldb::DB> db_;
+  std::vector<std::string> hosts_;
+};
+
+}  // namespace
+
+TEST_F(HTTPSEKeyFilterPerfTest, LeveldbOnly) {
+  RunTest(nullptr, "leveldb_only");
+}
+
+TEST_F(HTTPSEKeyFilterPerfTest, Filtered) {
+  std::unique_ptr<HTTPSEKeyFilter> filter =
+      HTTPSEKeyFilter::BuildFromDB(db_.get());
+  ASSERT_TRUE(filter);
+  RunTest(filter.get(), "filtered");
+}
+
+}  // namespace brave_shields
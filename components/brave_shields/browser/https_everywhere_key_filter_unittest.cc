@@ -0,0 +1,41 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_key_filter.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+TEST(HTTPSEKeyFilterTest, NoFalseNegatives) {
+  HTTPSEKeyFilter filter(1000);
+  for (int i = 0; i < 1000; ++i)
+    filter.Add("com.site" + std::to_string(i) + ".*");
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_TRUE(filter.MayContain("com.site" + std::to_string(i) + ".*"));
+}
+
+TEST(HTTPSEKeyFilterTest, FewFalsePositives) {
+  HTTPSEKeyFilter filter(1000);
+  for (int i = 0; i < 1000; ++i)
+    filter.Add("com.site" + std::to_string(i));
+
+  int false_positives = 0;
+  for (int i = 0; i < 10000; ++i) {
+    if (filter.MayContain("org.other" + std::to_string(i)))
+      false_positives++;
+  }
+  // ~1% expected, leave plenty of slack.
+  EXPECT_LT(false_positives, 300);
+}
+
+TEST(HTTPSEKeyFilterTest, EmptyFilter) {
+  HTTPSEKeyFilter filter(0);
+  EXPECT_FALSE(filter.MayContain("com.example"));
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,131 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/values.h"
+#include "third_party/re2/src/re2/re2.h"
+#include "third_party/re2/src/re2/set.h"
+
+namespace brave_shields {
+
+struct HTTPSERuleset::Rule {
+  // "d" rules just upgrade the scheme.
+  bool is_default = false;
+  std::unique_ptr<re2::RE2> from;
+  std::string to;
+};
+
+struct HTTPSERuleset::Ruleset {
+  // All exclusion patterns of the ruleset, matched in one pass. Null if the
+  // ruleset has none.
+  std::unique_ptr<re2::RE2::Set> exclusions;
+  std::vector<Rule> rules;
+  // A ruleset without a valid rule list ends the lookup, same as it always
+  // has.
+  bool has_rules = false;
+};
+
+HTTPSERuleset::HTTPSERuleset() = default;
+
+HTTPSERuleset::~HTTPSERuleset() = default;
+
+// static
+scoped_refptr<HTTPSERuleset> HTTPSERuleset::Parse(const std::string& json) {
+  base::Optional<base::Value> json_object = base::JSONReader::Read(json);
+  if (!json_object || !json_object->is_list())
+    return nullptr;
+
+  scoped_refptr<HTTPSERuleset> result(new HTTPSERuleset());
+  for (const auto& ruleset_value : json_object->GetList()) {
+    if (!ruleset_value.is_dict())
+      continue;
+
+    Ruleset ruleset;
+    const base::Value* exclusions = ruleset_value.FindListKey("e");
+    if (exclusions) {
+      auto exclusion_set = std::make_unique<re2::RE2::Set>(
+          re2::RE2::DefaultOptions, re2::RE2::ANCHOR_BOTH);
+      bool has_exclusions = false;
+      for (const auto& exclusion : exclusions->GetList()) {
+        const std::string* pattern =
+            exclusion.is_dict() ? exclusion.FindStringKey("p") : nullptr;
+        if (!pattern)
+          continue;
+        if (exclusion_set->Add(CorrecttoRuleToRE2Engine(*pattern), nullptr) >=
+            0) {
+          has_exclusions = true;
+        }
+      }
+      if (has_exclusions && exclusion_set->Compile())
+        ruleset.exclusions = std::move(exclusion_set);
+    }
+
+    const base::Value* rules = ruleset_value.FindListKey("r");
+    if (rules) {
+      ruleset.has_rules = true;
+      for (const auto& rule_value : rules->GetList()) {
+        if (!rule_value.is_dict())
+          continue;
+        Rule rule;
+        if (rule_value.FindKey("d")) {
+          rule.is_default = true;
+          ruleset.rules.push_back(std::move(rule));
+          continue;
+        }
+        const std::string* from = rule_value.FindStringKey("f");
+        const std::string* to = rule_value.FindStringKey("t");
+        if (!from || !to)
+          continue;
+        rule.from = std::make_unique<re2::RE2>(*from);
+        if (!rule.from->ok())
+          continue;
+        rule.to = CorrecttoRuleToRE2Engine(*to);
+        ruleset.rules.push_back(std::move(rule));
+      }
+    }
+    result->rulesets_.push_back(std::move(ruleset));
+  }
+  return result;
+}
+
+// static
+std::string HTTPSERuleset::CorrecttoRuleToRE2Engine(const std::string& to) {
+  std::string correctedto(to);
+  size_t pos = to.find("$");
+  while (std::string::npos != pos) {
+    correctedto[pos] = '\\';
+    pos = correctedto.find("$");
+  }
+
+  return correctedto;
+}
+
+std::string HTTPSERuleset::Apply(const std::string& url) const {
+  for (const auto& ruleset : rulesets_) {
+    if (ruleset.exclusions && ruleset.exclusions->Match(url, nullptr))
+      return "";
+
+    if (!ruleset.has_rules)
+      return "";
+
+    for (const auto& rule : ruleset.rules) {
+      if (rule.is_default) {
+        std::string new_url(url);
+        return new_url.insert(4, "s");
+      }
+
+      std::string new_url(url);
+      if (re2::RE2::Replace(&new_url, *rule.from, rule.to) && new_url != url)
+        return new_url;
+    }
+  }
+  return "";
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,52 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+
+namespace re2 {
+class RE2;
+}  // namespace re2
+
+namespace brave_shields {
+
+// The rulesets stored for one HTTPS Everywhere leveldb key, decoded from JSON
+// and with all of their regular expressions compiled, so a lookup only has to
+// run them. Immutable once parsed, so it can be applied on any thread.
+class HTTPSERuleset : public base::RefCountedThreadSafe<HTTPSERuleset> {
+ public:
+  // Returns null if |json| isn't a list of rulesets.
+  static scoped_refptr<HTTPSERuleset> Parse(const std::string& json);
+
+  // HTTPS Everywhere rules use $1 for backreferences, RE2 uses \1.
+  static std::string CorrecttoRuleToRE2Engine(const std::string& to);
+
+  // Returns the rewritten |url|, or an empty string if no rule applies.
+  std::string Apply(const std::string& url) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<HTTPSERuleset>;
+
+  struct Rule;
+  struct Ruleset;
+
+  HTTPSERuleset();
+  ~HTTPSERuleset();
+
+  std::vector<Ruleset> rulesets_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERuleset);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
@@ -0,0 +1,104 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace brave_shields {
+
+namespace {
+
+constexpr int kNumRulesets = 50;
+constexpr int kNumLookups = 20000;
+
+constexpr char kMetricPrefix[] = "HTTPSERuleset.";
+constexpr char kMetricLookupTime[] = "lookup_time";
+constexpr char kMetricLookupsPerSecond[] = "lookups_per_second";
+
+// Shaped like the larger entries in the HTTPS Everywhere DB: a few exclusions
+// followed by a handful of rewrite rules.
+std::string MakeRulesetJSON(int i) {
+  return base::StringPrintf(
+      R"([{"e": [{"p": "^http://site%d\\.com/plain/.*"},
+                 {"p": "^http://site%d\\.com/legacy/.*"},
+                 {"p": "^http://cdn\\.site%d\\.com/v1/.*"}],
+           "r": [{"f": "^http://static\\.site%d\\.com/",
+                  "t": "https://static.site%d.com/"},
+                 {"f": "^http://cdn\\.site%d\\.com/",
+                  "t": "https://cdn.site%d.com/"},
+                 {"f": "^http://(www\\.)?site%d\\.com/",
+                  "t": "https://$1site%d.com/"}]}])",
+      i, i, i, i, i, i, i, i, i);
+}
+
+std::string MakeURL(int i) {
+  static const char* const kPaths[] = {"/", "/plain/page", "/a/b/c?q=1",
+                                 "/legacy/x", "/img/logo.png"};
+  static const char* const kHosts[] = {"www.", "", "cdn.", "static."};
+  return base::StringPrintf("http://%ssite%d.com%s", kHosts[i % 4],
+                            i % kNumRulesets, kPaths[i % 5]);
+}
+
+class HTTPSERulesetPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < kNumRulesets; ++i)
+      rulesets_json_.push_back(MakeRulesetJSON(i));
+    for (int i = 0; i < kNumLookups; ++i)
+      urls_.push_back(MakeURL(i));
+  }
+
+  void Report(const std::string& story, base::TimeDelta elapsed) {
+    perf_test::PerfResultReporter reporter(kMetricPrefix, story);
+    reporter.RegisterImportantMetric(kMetricLookupTime, "ms");
+    reporter.RegisterImportantMetric(kMetricLookupsPerSecond, "runs/s");
+    reporter.AddResult(kMetricLookupTime, elapsed);
+    reporter.AddResult(kMetricLookupsPerSecond,
+                       static_cast<size_t>(kNumLookups / elapsed.InSecondsF()));
+  }
+
+  std::vector<std::string> rulesets_json_;
+  std::vector<std::string> urls_;
+};
+
+}  // namespace
+
+// What every lookup used to cost: decode the JSON and build the regular
+// expressions, then apply them once.
+TEST_F(HTTPSERulesetPerfTest, ParseOnEveryLookup) {
+  size_t rewritten = 0;
+  base::ElapsedTimer timer;
+  for (int i = 0; i < kNumLookups; ++i) {
+    auto ruleset = HTTPSERuleset::Parse(rulesets_json_[i % kNumRulesets]);
+    if (!ruleset->Apply(urls_[i]).empty())
+      rewritten++;
+  }
+  Report("parse_on_every_lookup", timer.Elapsed());
+  EXPECT_GT(rewritten, 0u);
+}
+
+TEST_F(HTTPSERulesetPerfTest, Compiled) {
+  std::vector<scoped_refptr<HTTPSERuleset>> rulesets;
+  for (const auto& json : rulesets_json_)
+    rulesets.push_back(HTTPSERuleset::Parse(json));
+
+  size_t rewritten = 0;
+  base::ElapsedTimer timer;
+  for (int i = 0; i < kNumLookups; ++i) {
+    if (!rulesets[i % kNumRulesets]->Apply(urls_[i]).empty())
+      rewritten++;
+  }
+  Report("compiled", timer.Elapsed());
+  EXPECT_GT(rewritten, 0u);
+}
+
+}  // namespace brave_shields
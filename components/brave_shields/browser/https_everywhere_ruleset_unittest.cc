@@ -0,0 +1,52 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brave_shields {
+
+TEST(HTTPSERulesetTest, InvalidJSON) {
+  EXPECT_FALSE(HTTPSERuleset::Parse("not json"));
+  EXPECT_FALSE(HTTPSERuleset::Parse("{}"));
+}
+
+TEST(HTTPSERulesetTest, DefaultRule) {
+  auto ruleset = HTTPSERuleset::Parse(R"([{"r": [{"d": 1}]}])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("https://example.com/", ruleset->Apply("http://example.com/"));
+}
+
+TEST(HTTPSERulesetTest, RewriteRule) {
+  auto ruleset = HTTPSERuleset::Parse(
+      R"([{"r": [{"f": "^http://(www\\.)?example\\.com/",
+                  "t": "https://$1example.com/"}]}])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("https://www.example.com/a?b",
+            ruleset->Apply("http://www.example.com/a?b"));
+  EXPECT_EQ("", ruleset->Apply("http://example.org/"));
+}
+
+TEST(HTTPSERulesetTest, Exclusions) {
+  auto ruleset = HTTPSERuleset::Parse(
+      R"([{"e": [{"p": "^http://example\\.com/plain/.*"},
+                 {"p": "^http://example\\.com/old"}],
+           "r": [{"d": 1}]}])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("", ruleset->Apply("http://example.com/plain/a"));
+  EXPECT_EQ("", ruleset->Apply("http://example.com/old"));
+  // Exclusions have to match the whole URL.
+  EXPECT_EQ("https://example.com/old/a",
+            ruleset->Apply("http://example.com/old/a"));
+}
+
+TEST(HTTPSERulesetTest, MissingRulesEndLookup) {
+  auto ruleset = HTTPSERuleset::Parse(R"([{"e": []}, {"r": [{"d": 1}]}])");
+  ASSERT_TRUE(ruleset);
+  EXPECT_EQ("", ruleset->Apply("http://example.com/"));
+}
+
+}  // namespace brave_shields
@@ -12,15 +12,13 @@
 
 #include "base/base_paths.h"
 #include "base/bind.h"
-#include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
-#include "base/values.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
@@ -30,6 +28,9 @@
 
 namespace {
 
+// Number of leveldb keys whose rulesets are kept compiled in memory.
+constexpr size_t kCompiledRulesetCacheSize = 500;
+
 std::vector<std::string> Split(const std::string& s, char delim) {
   std::stringstream ss(s);
   std::string item;
@@ -100,6 +101,7 @@ HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
 HTTPSEverywhereService::HTTPSEverywhereService(
     BraveComponent::Delegate* delegate)
     : BaseBraveShieldsService(delegate),
+      compiled_rulesets_(kCompiledRulesetCacheSize),
       level_db_(nullptr) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
@@ -128,6 +130,8 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
   }
 
   CloseDatabase();
+  compiled_rulesets_.Clear();
+  host_cache_.Clear();
 
   leveldb::Options options;
   leveldb::Status status =
@@ -141,6 +145,10 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
     CloseDatabase();
     return;
   }
+
+  // Most hosts have no rulesets; knowing every key up front lets their
+  // lookups skip leveldb.
+  key_filter_ = HTTPSEKeyFilter::BuildFromDB(level_db_);
 }
 
 void HTTPSEverywhereService::OnComponentReady(
@@ -170,33 +178,21 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     return false;
   }
 
-  if (recently_used_cache_.get(url->spec(), new_url)) {
-    AddHTTPSEUrlToRedirectList(request_identifier);
-    return true;
-  }
-
-  GURL candidate_url(*url);
-  if (g_ignore_port_for_test_ && candidate_url.has_port()) {
-    GURL::Replacements replacements;
-    replacements.ClearPort();
-    candidate_url = candidate_url.ReplaceComponents(replacements);
+  // This only runs after a host cache miss on the UI thread, so the rulesets
+  // are resolved without checking the cache again.
+  const GURL candidate_url = GetCandidateURL(*url);
+  HTTPSEHostRulesets rulesets;
+  for (const auto& domain : ExpandDomainForLookup(candidate_url.host())) {
+    scoped_refptr<const HTTPSERuleset> ruleset = GetCompiledRuleset(domain);
+    if (ruleset)
+      rulesets.push_back(std::move(ruleset));
   }
+  host_cache_.Put(candidate_url.host(), rulesets);
 
-  const std::vector<std::string> domains =
-      ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      *new_url = ApplyHTTPSRule(candidate_url.spec(), value);
-      if (0 != new_url->length()) {
-        recently_used_cache_.add(candidate_url.spec(), *new_url);
-        AddHTTPSEUrlToRedirectList(request_identifier);
-        return true;
-      }
-    }
-  }
-  recently_used_cache_.remove(candidate_url.spec());
-  return false;
+  if (!ApplyRulesets(rulesets, candidate_url.spec(), new_url))
+    return false;
+  AddHTTPSEUrlToRedirectList(request_identifier);
+  return true;
 }
 
 bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
@@ -213,11 +209,18 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
     return false;
   }
 
-  if (recently_used_cache_.get(url->spec(), cached_url)) {
+  const GURL candidate_url = GetCandidateURL(*url);
+  HTTPSEHostRulesets rulesets;
+  const bool hit = host_cache_.Get(candidate_url.host(), &rulesets);
+  UMA_HISTOGRAM_BOOLEAN("Brave.HTTPSE.HostCacheHit", hit);
+  if (!hit)
+    return false;
+
+  // A cached host with no applicable rule is still an answer: there's no
+  // redirect and nothing left to look up.
+  if (ApplyRulesets(rulesets, candidate_url.spec(), cached_url))
     AddHTTPSEUrlToRedirectList(request_identifier);
-    return true;
-  }
-  return false;
+  return true;
 }
 
 bool HTTPSEverywhereService::ShouldHTTPSERedirect(
@@ -262,116 +265,44 @@ void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
   }
 }
 
-std::string HTTPSEverywhereService::ApplyHTTPSRule(
-    const std::string& originalUrl,
-    const std::string& rule) {
-  base::Optional<base::Value> json_object = base::JSONReader::Read(rule);
-  if (base::nullopt == json_object || !json_object->is_list()) {
-    return "";
-  }
-
-  base::Value::ConstListView topValues = json_object->GetList();
-  for (auto it = topValues.cbegin(); it != topValues.cend(); ++it) {
-    if (!it->is_dict()) {
-      continue;
-    }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    it->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
-    }
-
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
-
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
-    }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
+scoped_refptr<const HTTPSERuleset>
+HTTPSEverywhereService::GetCompiledRuleset(const std::string& key) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = compiled_rulesets_.Get(key);
+  if (it != compiled_rulesets_.end())
+    return it->second;
+
+  if (key_filter_ && !key_filter_->MayContain(key))
+    return nullptr;
+
+  std::string value = leveldbGet(level_db_, key);
+  if (value.empty())
+    return nullptr;
+  scoped_refptr<const HTTPSERuleset> ruleset = HTTPSERuleset::Parse(value);
+  if (ruleset)
+    compiled_rulesets_.Put(key, ruleset);
+  return ruleset;
+}
 
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
-    }
-  }
-  return "";
+// static
+GURL HTTPSEverywhereService::GetCandidateURL(const GURL& url) {
+  if (!g_ignore_port_for_test_ || !url.has_port())
+    return url;
+  GURL::Replacements replacements;
+  replacements.ClearPort();
+  return url.ReplaceComponents(replacements);
 }
 
-std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
-    const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
+// static
+bool HTTPSEverywhereService::ApplyRulesets(const HTTPSEHostRulesets& rulesets,
+                                           const std::string& url,
+                                           std::string* new_url) {
+  for (const auto& ruleset : rulesets) {
+    *new_url = ruleset->Apply(url);
+    if (!new_url->empty())
+      return true;
   }
-
-  return correctedto;
+  return false;
 }
 
 void HTTPSEverywhereService::CloseDatabase() {
@@ -380,6 +311,7 @@ void HTTPSEverywhereService::CloseDatabase() {
     delete level_db_;
     level_db_ = nullptr;
   }
+  key_filter_.reset();
 }
 
 // static
@@ -10,12 +10,15 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
 #include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
-#include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
+#include "brave/components/brave_shields/browser/https_everywhere_host_cache.h"
+#include "brave/components/brave_shields/browser/https_everywhere_key_filter.h"
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
 
 namespace leveldb {
 class DB;
@@ -63,9 +66,15 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
 
   void AddHTTPSEUrlToRedirectList(const uint64_t& request_id);
   bool ShouldHTTPSERedirect(const uint64_t& request_id);
-  std::string ApplyHTTPSRule(const std::string& originalUrl,
-      const std::string& rule);
-  std::string CorrecttoRuleToRE2Engine(const std::string& to);
+  // Returns the compiled rulesets stored under |key|, or null if there are
+  // none.
+  scoped_refptr<const HTTPSERuleset> GetCompiledRuleset(
+      const std::string& key);
+  // Applies the first of |rulesets| that rewrites |url|.
+  static bool ApplyRulesets(const HTTPSEHostRulesets& rulesets,
+                            const std::string& url,
+                            std::string* new_url);
+  static GURL GetCandidateURL(const GURL& url);
 
  private:
   friend class ::HTTPSEverywhereServiceTest;
@@ -83,8 +92,11 @@ class HTTPSEverywhereService : public BaseBraveShieldsService,
 
   base::Lock httpse_get_urls_redirects_count_mutex_;
   std::vector<HTTPSE_REDIRECTS_COUNT_ST> httpse_urls_redirects_count_;
-  HTTPSERecentlyUsedCache<std::string> recently_used_cache_;
+  HTTPSEHostCache host_cache_;
+  base::MRUCache<std::string, scoped_refptr<const HTTPSERuleset>>
+      compiled_rulesets_;
   leveldb::DB* level_db_;
+  std::unique_ptr<HTTPSEKeyFilter> key_filter_;
 
   SEQUENCE_CHECKER(sequence_checker_);
   DISALLOW_COPY_AND_ASSIGN(HTTPSEverywhereService);
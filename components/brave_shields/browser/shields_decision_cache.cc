@@ -0,0 +1,104 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/shields_decision_cache.h"
+
+#include "base/strings/string_number_conversions.h"
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+namespace {
+
+std::string GetVerdictKey(const GURL& request_url,
+                          blink::mojom::ResourceType resource_type,
+                          const std::string& tab_host) {
+  GURL::Replacements replacements;
+  replacements.ClearRef();
+  return tab_host + " " +
+         base::NumberToString(static_cast<int>(resource_type)) + " " +
+         request_url.ReplaceComponents(replacements).spec();
+}
+
+}  // namespace
+
+AdBlockVerdict::AdBlockVerdict() = default;
+
+AdBlockVerdict::AdBlockVerdict(const AdBlockVerdict& other) = default;
+
+AdBlockVerdict::~AdBlockVerdict() = default;
+
+ShieldsDecisionCache::ShieldsDecisionCache(HostContentSettingsMap* map)
+    : map_(map), policies_(kMaxPolicies), verdicts_(kMaxVerdicts) {
+  map_->AddObserver(this);
+}
+
+ShieldsDecisionCache::~ShieldsDecisionCache() {
+  map_->RemoveObserver(this);
+}
+
+ShieldsPolicy ShieldsDecisionCache::GetPolicy(const GURL& tab_origin) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  const std::string key = tab_origin.spec();
+  auto it = policies_.Get(key);
+  if (it != policies_.end())
+    return it->second;
+
+  ShieldsPolicy policy;
+  policy.shields_up = GetBraveShieldsEnabled(map_, tab_origin);
+  policy.allow_ads = GetAdControlType(map_, tab_origin) == ControlType::ALLOW;
+  policy.allow_http_upgradable_resource =
+      !GetHTTPSEverywhereEnabled(map_, tab_origin);
+  policy.allow_referrers = AllowReferrers(map_, tab_origin);
+  policies_.Put(key, policy);
+  return policy;
+}
+
+bool ShieldsDecisionCache::GetAdBlockVerdict(
+    const GURL& request_url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host,
+    uint64_t engine_version,
+    AdBlockVerdict* verdict) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  auto it = verdicts_.Get(GetVerdictKey(request_url, resource_type, tab_host));
+  if (it == verdicts_.end())
+    return false;
+  if (it->second.engine_version != engine_version ||
+      it->second.expiration <= base::TimeTicks::Now()) {
+    verdicts_.Erase(it);
+    return false;
+  }
+  *verdict = it->second.verdict;
+  return true;
+}
+
+void ShieldsDecisionCache::SetAdBlockVerdict(
+    const GURL& request_url,
+    blink::mojom::ResourceType resource_type,
+    const std::string& tab_host,
+    uint64_t engine_version,
+    const AdBlockVerdict& verdict) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  verdicts_.Put(
+      GetVerdictKey(request_url, resource_type, tab_host),
+      CachedVerdict{verdict, engine_version,
+                    base::TimeTicks::Now() + base::TimeDelta::FromSeconds(
+                                                 kVerdictLifetimeSeconds)});
+}
+
+void ShieldsDecisionCache::OnContentSettingChanged(
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern,
+    ContentSettingsType content_type) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  // Settings change rarely, and patterns can match any number of origins, so
+  // just start over. Verdicts don't depend on content settings.
+  policies_.Clear();
+}
+
+}  // namespace brave_shields
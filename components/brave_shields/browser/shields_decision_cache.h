@@ -0,0 +1,102 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_SHIELDS_DECISION_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_SHIELDS_DECISION_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+#include "brave/components/brave_shields/browser/cname_cache.h"
+#include "components/content_settings/core/browser/content_settings_observer.h"
+#include "components/keyed_service/core/keyed_service.h"
+#include "third_party/blink/public/mojom/loader/resource_load_info.mojom-shared.h"
+
+class GURL;
+class HostContentSettingsMap;
+
+namespace brave_shields {
+
+// The shields settings that apply to requests made from a top-level site.
+struct ShieldsPolicy {
+  bool shields_up = true;
+  bool allow_ads = false;
+  bool allow_http_upgradable_resource = false;
+  bool allow_referrers = false;
+};
+
+// The final adblock answer for a request, CNAME uncloaking included.
+struct AdBlockVerdict {
+  AdBlockVerdict();
+  AdBlockVerdict(const AdBlockVerdict& other);
+  ~AdBlockVerdict();
+
+  bool blocked = false;
+  std::string mock_data_url;
+};
+
+// Per-profile cache of shields decisions, used on the UI thread by the
+// request handler.
+//
+// Policies are computed from content settings once per top-level origin and
+// dropped whenever a content setting changes. Adblock verdicts are kept for a
+// short while per (tab host, resource type, URL), so pages that fetch the
+// same beacons and trackers over and over skip the CNAME lookup and engine
+// matching. A verdict is only reused with the engines it was computed with.
+// The profile's CNAME cache lives here too, so it goes away with the profile.
+class ShieldsDecisionCache : public KeyedService,
+                             public content_settings::Observer {
+ public:
+  static constexpr size_t kMaxPolicies = 256;
+  static constexpr size_t kMaxVerdicts = 2048;
+  static constexpr int kVerdictLifetimeSeconds = 60;
+
+  explicit ShieldsDecisionCache(HostContentSettingsMap* map);
+  ~ShieldsDecisionCache() override;
+
+  ShieldsPolicy GetPolicy(const GURL& tab_origin);
+
+  bool GetAdBlockVerdict(const GURL& request_url,
+                         blink::mojom::ResourceType resource_type,
+                         const std::string& tab_host,
+                         uint64_t engine_version,
+                         AdBlockVerdict* verdict);
+  void SetAdBlockVerdict(const GURL& request_url,
+                         blink::mojom::ResourceType resource_type,
+                         const std::string& tab_host,
+                         uint64_t engine_version,
+                         const AdBlockVerdict& verdict);
+
+  CnameCache* cname_cache() { return &cname_cache_; }
+
+ private:
+  struct CachedVerdict {
+    AdBlockVerdict verdict;
+    uint64_t engine_version;
+    base::TimeTicks expiration;
+  };
+
+  // content_settings::Observer overrides:
+  void OnContentSettingChanged(const ContentSettingsPattern& primary_pattern,
+                               const ContentSettingsPattern& secondary_pattern,
+                               ContentSettingsType content_type) override;
+
+  HostContentSettingsMap* map_;  // Not owned
+  base::MRUCache<std::string, ShieldsPolicy> policies_;
+  base::MRUCache<std::string, CachedVerdict> verdicts_;
+  CnameCache cname_cache_;
+
+  THREAD_CHECKER(thread_checker_);
+  DISALLOW_COPY_AND_ASSIGN(ShieldsDecisionCache);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_SHIELDS_DECISION_CACHE_H_
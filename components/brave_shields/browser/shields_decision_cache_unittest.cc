@@ -0,0 +1,78 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/shields_decision_cache.h"
+
+#include <memory>
+
+#include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "chrome/browser/content_settings/host_content_settings_map_factory.h"
+#include "chrome/test/base/testing_profile.h"
+#include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "content/public/test/browser_task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+class ShieldsDecisionCacheTest : public testing::Test {
+ public:
+  void SetUp() override {
+    profile_ = std::make_unique<TestingProfile>();
+    cache_ = std::make_unique<ShieldsDecisionCache>(map());
+  }
+
+  void TearDown() override { cache_.reset(); }
+
+  HostContentSettingsMap* map() {
+    return HostContentSettingsMapFactory::GetForProfile(profile_.get());
+  }
+  ShieldsDecisionCache* cache() { return cache_.get(); }
+
+ private:
+  content::BrowserTaskEnvironment task_environment_;
+  std::unique_ptr<TestingProfile> profile_;
+  std::unique_ptr<ShieldsDecisionCache> cache_;
+};
+
+TEST_F(ShieldsDecisionCacheTest, PolicyFollowsContentSettings) {
+  const GURL origin("https://brave.com/");
+  EXPECT_TRUE(cache()->GetPolicy(origin).shields_up);
+
+  SetBraveShieldsEnabled(map(), false, origin);
+  EXPECT_FALSE(cache()->GetPolicy(origin).shields_up);
+
+  SetAdControlType(map(), ControlType::ALLOW, origin);
+  EXPECT_TRUE(cache()->GetPolicy(origin).allow_ads);
+  EXPECT_FALSE(cache()->GetPolicy(GURL("https://example.com/")).allow_ads);
+}
+
+TEST_F(ShieldsDecisionCacheTest, AdBlockVerdicts) {
+  const GURL url("https://tracker.com/pixel.gif?x=1");
+  const auto type = blink::mojom::ResourceType::kImage;
+  AdBlockVerdict verdict;
+  EXPECT_FALSE(cache()->GetAdBlockVerdict(url, type, "brave.com", 1, &verdict));
+
+  verdict.blocked = true;
+  cache()->SetAdBlockVerdict(url, type, "brave.com", 1, verdict);
+
+  AdBlockVerdict cached;
+  EXPECT_TRUE(cache()->GetAdBlockVerdict(
+      GURL("https://tracker.com/pixel.gif?x=1#a"), type, "brave.com", 1,
+      &cached));
+  EXPECT_TRUE(cached.blocked);
+
+  // Different query, tab host, resource type or engines don't match.
+  EXPECT_FALSE(cache()->GetAdBlockVerdict(
+      GURL("https://tracker.com/pixel.gif?x=2"), type, "brave.com", 1,
+      &cached));
+  EXPECT_FALSE(
+      cache()->GetAdBlockVerdict(url, type, "example.com", 1, &cached));
+  EXPECT_FALSE(cache()->GetAdBlockVerdict(
+      url, blink::mojom::ResourceType::kScript, "brave.com", 1, &cached));
+  EXPECT_FALSE(cache()->GetAdBlockVerdict(url, type, "brave.com", 2, &cached));
+}
+
+}  // namespace brave_shields
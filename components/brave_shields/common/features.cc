@@ -14,5 +14,18 @@ const base::Feature kBraveAdblockCosmeticFiltering{
     "BraveAdblockCosmeticFiltering",
     base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Let low-risk subresources through without waiting for their CNAME to be
+// resolved, so that only later requests to the same host are uncloaked.
+const base::Feature kBraveAdblockSpeculativeCnameCheck{
+    "BraveAdblockSpeculativeCnameCheck",
+    base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Match requests against the adblock engines on a shields-owned sequence as
+// part of the OnBeforeURLRequest chain, instead of batching them from the UI
+// thread.
+const base::Feature kBraveShieldsOffMainThreadRequestChain{
+    "BraveShieldsOffMainThreadRequestChain",
+    base::FEATURE_DISABLED_BY_DEFAULT};
+
 }  // namespace features
 }  // namespace brave_shields
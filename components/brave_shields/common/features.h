@@ -13,6 +13,8 @@ struct Feature;
 namespace brave_shields {
 namespace features {
 extern const base::Feature kBraveAdblockCosmeticFiltering;
+extern const base::Feature kBraveAdblockSpeculativeCnameCheck;
+extern const base::Feature kBraveShieldsOffMainThreadRequestChain;
 }  // namespace features
 }  // namespace brave_shields
 
@@ -0,0 +1,23 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/challenge_bypass_ristretto/batch_sharding.h"
+
+#include <algorithm>
+
+namespace brave_challenge_bypass_ristretto {
+
+namespace {
+
+// Smaller shards spend more time being posted than being processed.
+const size_t kMinItemsPerShard = 16;
+
+}  // namespace
+
+size_t GetShardCount(const size_t count, const size_t max_shards) {
+  return std::max<size_t>(1, std::min(max_shards, count / kMinItemsPerShard));
+}
+
+}  // namespace brave_challenge_bypass_ristretto
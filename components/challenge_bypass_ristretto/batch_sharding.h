@@ -0,0 +1,117 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_CHALLENGE_BYPASS_RISTRETTO_BATCH_SHARDING_H_
+#define BRAVE_COMPONENTS_CHALLENGE_BYPASS_RISTRETTO_BATCH_SHARDING_H_
+
+#include <stddef.h>
+
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/optional.h"
+#include "base/task/thread_pool.h"
+
+namespace brave_challenge_bypass_ristretto {
+
+// Processes the items in [|begin|, |end|) and returns one result per item, or
+// base::nullopt if the shard failed.
+template <typename T>
+using ShardTask = base::RepeatingCallback<base::Optional<std::vector<T>>(
+    const size_t begin,
+    const size_t end)>;
+
+// Runs with the results of all shards joined in item order, or with
+// base::nullopt if any shard failed.
+template <typename T>
+using ShardsCallback =
+    base::OnceCallback<void(base::Optional<std::vector<T>> results)>;
+
+// Returns the number of shards [0, |count|) is split into, which is at most
+// |max_shards| and never less than one.
+size_t GetShardCount(const size_t count, const size_t max_shards);
+
+namespace internal {
+
+template <typename T>
+struct Shards {
+  Shards(const size_t count, ShardsCallback<T> callback)
+      : results(count), pending(count), callback(std::move(callback)) {}
+
+  std::vector<std::vector<T>> results;
+  size_t pending;
+  ShardsCallback<T> callback;
+};
+
+template <typename T>
+void OnShardProcessed(std::shared_ptr<Shards<T>> shards,
+                      const size_t shard,
+                      base::Optional<std::vector<T>> result) {
+  if (!shards->callback) {
+    // An earlier shard failed and the callback has already run.
+    return;
+  }
+
+  if (!result) {
+    std::move(shards->callback).Run(base::nullopt);
+    return;
+  }
+
+  shards->results[shard] = std::move(*result);
+
+  shards->pending--;
+  if (shards->pending > 0)
+    return;
+
+  std::vector<T> joined_results;
+  for (auto& results : shards->results) {
+    joined_results.insert(joined_results.end(),
+                          std::make_move_iterator(results.begin()),
+                          std::make_move_iterator(results.end()));
+  }
+
+  std::move(shards->callback).Run(std::move(joined_results));
+}
+
+}  // namespace internal
+
+// Splits [0, |count|) into contiguous ranges and runs |task| for each of them
+// on the thread pool. |callback| is run on the calling sequence once every
+// shard has finished, with the results joined in item order regardless of
+// which worker finishes first.
+//
+// If a shard fails |callback| is run with base::nullopt as soon as its reply
+// arrives, and the results of the remaining shards are dropped. Shard tasks
+// are skipped on shutdown, in which case |callback| never runs. Callers that
+// can be destroyed first should bind |callback| to a weak pointer.
+template <typename T>
+void PostShards(const size_t count,
+                const size_t max_shards,
+                ShardTask<T> task,
+                ShardsCallback<T> callback) {
+  const size_t shard_count = GetShardCount(count, max_shards);
+
+  auto shards =
+      std::make_shared<internal::Shards<T>>(shard_count, std::move(callback));
+
+  for (size_t shard = 0; shard < shard_count; shard++) {
+    const size_t begin = count * shard / shard_count;
+    const size_t end = count * (shard + 1) / shard_count;
+    base::ThreadPool::PostTaskAndReplyWithResult(
+        FROM_HERE,
+        {base::TaskPriority::USER_VISIBLE,
+         base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+        base::BindOnce(task, begin, end),
+        base::BindOnce(&internal::OnShardProcessed<T>, shards, shard));
+  }
+}
+
+}  // namespace brave_challenge_bypass_ristretto
+
+#endif  // BRAVE_COMPONENTS_CHALLENGE_BYPASS_RISTRETTO_BATCH_SHARDING_H_
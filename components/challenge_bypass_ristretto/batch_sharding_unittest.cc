@@ -0,0 +1,102 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/challenge_bypass_ristretto/batch_sharding.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/optional.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=BatchShardingTest.*
+
+namespace brave_challenge_bypass_ristretto {
+
+namespace {
+
+base::Optional<std::vector<size_t>> Identity(const size_t begin,
+                                             const size_t end) {
+  std::vector<size_t> results;
+  for (size_t i = begin; i < end; i++)
+    results.push_back(i);
+  return results;
+}
+
+base::Optional<std::vector<size_t>> FailIfContains(const size_t item,
+                                                   const size_t begin,
+                                                   const size_t end) {
+  if (item >= begin && item < end)
+    return base::nullopt;
+  return Identity(begin, end);
+}
+
+void OnShards(int* calls,
+              base::Optional<std::vector<size_t>>* results,
+              base::Optional<std::vector<size_t>> shard_results) {
+  (*calls)++;
+  *results = std::move(shard_results);
+}
+
+}  // namespace
+
+class BatchShardingTest : public testing::Test {
+ protected:
+  base::test::TaskEnvironment task_environment_;
+};
+
+TEST_F(BatchShardingTest, GetShardCount) {
+  EXPECT_EQ(1u, GetShardCount(0, 4));
+  EXPECT_EQ(1u, GetShardCount(1, 4));
+  EXPECT_EQ(1u, GetShardCount(31, 4));
+  EXPECT_EQ(2u, GetShardCount(32, 4));
+  EXPECT_EQ(4u, GetShardCount(1000, 4));
+  EXPECT_EQ(1u, GetShardCount(1000, 1));
+}
+
+TEST_F(BatchShardingTest, JoinsShardsInItemOrder) {
+  int calls = 0;
+  base::Optional<std::vector<size_t>> results;
+  PostShards<size_t>(100, 4, base::BindRepeating(&Identity),
+                     base::BindOnce(&OnShards, &calls, &results));
+
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(1, calls);
+  ASSERT_TRUE(results);
+  EXPECT_EQ(Identity(0, 100), results);
+}
+
+TEST_F(BatchShardingTest, RunsCallbackOnceWithNulloptIfShardFails) {
+  int calls = 0;
+  base::Optional<std::vector<size_t>> results = std::vector<size_t>();
+  PostShards<size_t>(100, 4, base::BindRepeating(&FailIfContains, 60),
+                     base::BindOnce(&OnShards, &calls, &results));
+
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(1, calls);
+  EXPECT_FALSE(results);
+}
+
+TEST_F(BatchShardingTest, RunsCallbackOnceIfEveryShardFails) {
+  int calls = 0;
+  base::Optional<std::vector<size_t>> results = std::vector<size_t>();
+  PostShards<size_t>(
+      100, 4,
+      base::BindRepeating([](const size_t begin, const size_t end) {
+        return base::Optional<std::vector<size_t>>();
+      }),
+      base::BindOnce(&OnShards, &calls, &results));
+
+  task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(1, calls);
+  EXPECT_FALSE(results);
+}
+
+}  // namespace brave_challenge_bypass_ristretto
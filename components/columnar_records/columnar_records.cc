@@ -0,0 +1,342 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/columnar_records/columnar_records.h"
+
+#include <string.h>
+
+#include <limits>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "base/notreached.h"
+
+namespace columnar_records {
+
+namespace {
+
+size_t GetValueSize(const ColumnType column_type) {
+  switch (column_type) {
+    case ColumnType::kInt: {
+      return sizeof(int32_t);
+    }
+
+    case ColumnType::kInt64: {
+      return sizeof(int64_t);
+    }
+
+    case ColumnType::kDouble: {
+      return sizeof(double);
+    }
+
+    case ColumnType::kBool: {
+      return sizeof(uint8_t);
+    }
+
+    case ColumnType::kString: {
+      // String columns are variable length
+      return 0;
+    }
+  }
+
+  NOTREACHED();
+  return 0;
+}
+
+template <typename T>
+T ReadValue(const uint8_t* data) {
+  // Values are not aligned within the packed data
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+}  // namespace
+
+ColumnarRecords::ColumnarRecords() = default;
+
+ColumnarRecords::ColumnarRecords(ColumnarRecords&& records) = default;
+
+ColumnarRecords& ColumnarRecords::operator=(ColumnarRecords&& records) =
+    default;
+
+ColumnarRecords::~ColumnarRecords() = default;
+
+///////////////////////////////////////////////////////////////////////////////
+
+ColumnarRecordsBuilder::Column::Column() = default;
+
+ColumnarRecordsBuilder::Column::Column(const Column& column) = default;
+
+ColumnarRecordsBuilder::Column::~Column() = default;
+
+ColumnarRecordsBuilder::ColumnarRecordsBuilder(
+    const std::vector<ColumnType>& column_types) {
+  DCHECK(!column_types.empty());
+
+  columns_.resize(column_types.size());
+
+  for (size_t i = 0; i < column_types.size(); i++) {
+    Column& column = columns_.at(i);
+    column.column_type = column_types.at(i);
+
+    if (column.column_type == ColumnType::kString) {
+      column.string_offsets.push_back(0);
+    }
+  }
+}
+
+ColumnarRecordsBuilder::~ColumnarRecordsBuilder() = default;
+
+void ColumnarRecordsBuilder::AddInt(const int32_t value) {
+  AppendBytes(ColumnType::kInt, &value, sizeof(value));
+}
+
+void ColumnarRecordsBuilder::AddInt64(const int64_t value) {
+  AppendBytes(ColumnType::kInt64, &value, sizeof(value));
+}
+
+void ColumnarRecordsBuilder::AddDouble(const double value) {
+  AppendBytes(ColumnType::kDouble, &value, sizeof(value));
+}
+
+void ColumnarRecordsBuilder::AddBool(const bool value) {
+  const uint8_t byte = value ? 1 : 0;
+  AppendBytes(ColumnType::kBool, &byte, sizeof(byte));
+}
+
+void ColumnarRecordsBuilder::AddString(base::StringPiece value) {
+  Column* column = NextColumn(ColumnType::kString);
+
+  column->bytes.insert(column->bytes.end(), value.begin(), value.end());
+
+  DCHECK_LE(column->bytes.size(), std::numeric_limits<uint32_t>::max());
+  column->string_offsets.push_back(
+      static_cast<uint32_t>(column->bytes.size()));
+}
+
+ColumnarRecords ColumnarRecordsBuilder::Build() {
+  DCHECK_EQ(0UL, next_column_) << "Incomplete row";
+
+  ColumnarRecords records;
+  records.row_count = row_count_;
+
+  size_t size = 0;
+  for (const auto& column : columns_) {
+    DCHECK_LE(size, std::numeric_limits<uint32_t>::max());
+
+    records.column_types.push_back(column.column_type);
+    records.column_offsets.push_back(static_cast<uint32_t>(size));
+
+    size += column.string_offsets.size() * sizeof(uint32_t);
+    size += column.bytes.size();
+  }
+
+  mojo_base::BigBuffer data(size);
+
+  uint8_t* iter = data.data();
+  for (const auto& column : columns_) {
+    const size_t string_offsets_size =
+        column.string_offsets.size() * sizeof(uint32_t);
+    if (string_offsets_size > 0) {
+      memcpy(iter, column.string_offsets.data(), string_offsets_size);
+      iter += string_offsets_size;
+    }
+
+    if (!column.bytes.empty()) {
+      memcpy(iter, column.bytes.data(), column.bytes.size());
+      iter += column.bytes.size();
+    }
+  }
+
+  records.data = std::move(data);
+
+  return records;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ColumnarRecordsBuilder::Column* ColumnarRecordsBuilder::NextColumn(
+    const ColumnType column_type) {
+  DCHECK_LT(next_column_, columns_.size());
+
+  Column* column = &columns_.at(next_column_);
+  DCHECK_EQ(column_type, column->column_type);
+
+  next_column_++;
+  if (next_column_ == columns_.size()) {
+    next_column_ = 0;
+    row_count_++;
+  }
+
+  return column;
+}
+
+void ColumnarRecordsBuilder::AppendBytes(const ColumnType column_type,
+                                         const void* value,
+                                         const size_t size) {
+  Column* column = NextColumn(column_type);
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(value);
+  column->bytes.insert(column->bytes.end(), bytes, bytes + size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ColumnarRecordsReader::ColumnarRecordsReader(
+    std::vector<ColumnType> column_types,
+    std::vector<uint32_t> column_offsets,
+    const uint32_t row_count,
+    base::span<const uint8_t> data,
+    const std::vector<ColumnType>& expected_column_types)
+    : column_types_(std::move(column_types)),
+      column_offsets_(std::move(column_offsets)),
+      data_(data),
+      row_count_(row_count),
+      is_valid_(Validate(expected_column_types)) {}
+
+ColumnarRecordsReader::ColumnarRecordsReader(
+    const ColumnarRecords& records,
+    const std::vector<ColumnType>& expected_column_types)
+    : ColumnarRecordsReader(records.column_types,
+                            records.column_offsets,
+                            records.row_count,
+                            records.data,
+                            expected_column_types) {}
+
+ColumnarRecordsReader::~ColumnarRecordsReader() = default;
+
+int ColumnarRecordsReader::ColumnInt(const size_t row,
+                                     const size_t column) const {
+  const uint8_t* value = GetValue(row, column, ColumnType::kInt);
+  return value ? ReadValue<int32_t>(value) : 0;
+}
+
+int64_t ColumnarRecordsReader::ColumnInt64(const size_t row,
+                                           const size_t column) const {
+  const uint8_t* value = GetValue(row, column, ColumnType::kInt64);
+  return value ? ReadValue<int64_t>(value) : 0;
+}
+
+double ColumnarRecordsReader::ColumnDouble(const size_t row,
+                                           const size_t column) const {
+  const uint8_t* value = GetValue(row, column, ColumnType::kDouble);
+  return value ? ReadValue<double>(value) : 0.0;
+}
+
+bool ColumnarRecordsReader::ColumnBool(const size_t row,
+                                       const size_t column) const {
+  const uint8_t* value = GetValue(row, column, ColumnType::kBool);
+  return value && *value != 0;
+}
+
+base::StringPiece ColumnarRecordsReader::ColumnStringPiece(
+    const size_t row,
+    const size_t column) const {
+  const uint8_t* string_offsets = GetValue(row, column, ColumnType::kString);
+  if (!string_offsets) {
+    return base::StringPiece();
+  }
+
+  const uint32_t begin = ReadValue<uint32_t>(string_offsets);
+  const uint32_t end = ReadValue<uint32_t>(string_offsets + sizeof(uint32_t));
+
+  const uint8_t* strings = data_.data() + column_offsets_.at(column) +
+                           (row_count_ + 1) * sizeof(uint32_t);
+
+  return base::StringPiece(reinterpret_cast<const char*>(strings + begin),
+                           end - begin);
+}
+
+std::string ColumnarRecordsReader::ColumnString(const size_t row,
+                                                const size_t column) const {
+  const base::StringPiece value = ColumnStringPiece(row, column);
+  return std::string(value.data(), value.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ColumnarRecordsReader::Validate(
+    const std::vector<ColumnType>& expected_column_types) const {
+  if (column_types_ != expected_column_types) {
+    LOG(ERROR) << "Unexpected columnar record column types";
+    return false;
+  }
+
+  if (column_types_.size() != column_offsets_.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < column_types_.size(); i++) {
+    // Each column ends where the next one begins, or at the end of the data
+    // for the last column
+    const size_t offset = column_offsets_.at(i);
+    const size_t end = i + 1 < column_offsets_.size()
+                           ? column_offsets_.at(i + 1)
+                           : data_.size();
+    if (offset > end || end > data_.size()) {
+      return false;
+    }
+
+    const size_t available_size = end - offset;
+
+    const ColumnType column_type = column_types_.at(i);
+    if (column_type != ColumnType::kString) {
+      if (row_count_ > available_size / GetValueSize(column_type)) {
+        return false;
+      }
+
+      continue;
+    }
+
+    // String columns need |row_count_| + 1 offsets
+    if (row_count_ >= available_size / sizeof(uint32_t)) {
+      return false;
+    }
+
+    const size_t string_offsets_size = (row_count_ + 1) * sizeof(uint32_t);
+    const size_t strings_size = available_size - string_offsets_size;
+
+    uint32_t last_string_offset = 0;
+    for (size_t row = 0; row <= row_count_; row++) {
+      const uint32_t string_offset =
+          ReadValue<uint32_t>(data_.data() + offset + row * sizeof(uint32_t));
+      if (string_offset < last_string_offset ||
+          string_offset > strings_size) {
+        return false;
+      }
+
+      last_string_offset = string_offset;
+    }
+  }
+
+  return true;
+}
+
+const uint8_t* ColumnarRecordsReader::GetValue(
+    const size_t row,
+    const size_t column,
+    const ColumnType column_type) const {
+  DCHECK(is_valid_);
+  DCHECK_LT(row, row_count_);
+  DCHECK_LT(column, column_types_.size());
+  DCHECK_EQ(column_type, column_types_.at(column));
+
+  if (!is_valid_ || row >= row_count_ || column >= column_types_.size() ||
+      column_types_.at(column) != column_type) {
+    return nullptr;
+  }
+
+  const uint8_t* column_data = data_.data() + column_offsets_.at(column);
+
+  if (column_type == ColumnType::kString) {
+    return column_data + row * sizeof(uint32_t);
+  }
+
+  return column_data + row * GetValueSize(column_type);
+}
+
+}  // namespace columnar_records
@@ -0,0 +1,142 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_COLUMNAR_RECORDS_COLUMNAR_RECORDS_H_
+#define BRAVE_COMPONENTS_COLUMNAR_RECORDS_COLUMNAR_RECORDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "base/strings/string_piece.h"
+#include "mojo/public/cpp/base/big_buffer.h"
+
+namespace columnar_records {
+
+enum class ColumnType { kInt, kInt64, kDouble, kBool, kString };
+
+// Records packed column by column. Fixed size columns hold |row_count| values
+// back to back. String columns hold |row_count| + 1 offsets followed by the
+// concatenated strings, so that the |i|th string spans [offsets[i],
+// offsets[i + 1]). |column_offsets| are the offsets of each column in |data|.
+struct ColumnarRecords {
+  ColumnarRecords();
+  ColumnarRecords(ColumnarRecords&& records);
+  ColumnarRecords& operator=(ColumnarRecords&& records);
+  ~ColumnarRecords();
+
+  uint32_t row_count = 0;
+  std::vector<ColumnType> column_types;
+  std::vector<uint32_t> column_offsets;
+  mojo_base::BigBuffer data;
+};
+
+// Packs records column by column into |ColumnarRecords|. Values must be added
+// row by row in column order
+class ColumnarRecordsBuilder {
+ public:
+  explicit ColumnarRecordsBuilder(const std::vector<ColumnType>& column_types);
+
+  ~ColumnarRecordsBuilder();
+
+  ColumnarRecordsBuilder(const ColumnarRecordsBuilder&) = delete;
+  ColumnarRecordsBuilder& operator=(const ColumnarRecordsBuilder&) = delete;
+
+  void AddInt(const int32_t value);
+
+  void AddInt64(const int64_t value);
+
+  void AddDouble(const double value);
+
+  void AddBool(const bool value);
+
+  void AddString(base::StringPiece value);
+
+  ColumnarRecords Build();
+
+ private:
+  struct Column {
+    Column();
+    Column(const Column& column);
+    ~Column();
+
+    ColumnType column_type;
+    std::vector<uint8_t> bytes;
+    std::vector<uint32_t> string_offsets;
+  };
+
+  Column* NextColumn(const ColumnType column_type);
+
+  void AppendBytes(const ColumnType column_type,
+                   const void* value,
+                   const size_t size);
+
+  std::vector<Column> columns_;
+  size_t next_column_ = 0;
+  uint32_t row_count_ = 0;
+};
+
+// Reads values from packed records without unpacking them into records. The
+// data must outlive the reader, which copies the column types and offsets
+class ColumnarRecordsReader {
+ public:
+  // |expected_column_types| are the column types the caller reads. Records
+  // packed with other column types are not valid
+  ColumnarRecordsReader(std::vector<ColumnType> column_types,
+                        std::vector<uint32_t> column_offsets,
+                        const uint32_t row_count,
+                        base::span<const uint8_t> data,
+                        const std::vector<ColumnType>& expected_column_types);
+
+  ColumnarRecordsReader(const ColumnarRecords& records,
+                        const std::vector<ColumnType>& expected_column_types);
+
+  ~ColumnarRecordsReader();
+
+  ColumnarRecordsReader(const ColumnarRecordsReader&) = delete;
+  ColumnarRecordsReader& operator=(const ColumnarRecordsReader&) = delete;
+
+  // Returns false if the column types are not the expected ones, or if any
+  // column does not fit between its offset and the next column's offset, in
+  // which case no values should be read. Values read from records that are
+  // not valid are zero or empty
+  bool is_valid() const { return is_valid_; }
+
+  size_t row_count() const { return row_count_; }
+
+  int ColumnInt(const size_t row, const size_t column) const;
+
+  int64_t ColumnInt64(const size_t row, const size_t column) const;
+
+  double ColumnDouble(const size_t row, const size_t column) const;
+
+  bool ColumnBool(const size_t row, const size_t column) const;
+
+  base::StringPiece ColumnStringPiece(const size_t row,
+                                      const size_t column) const;
+
+  std::string ColumnString(const size_t row, const size_t column) const;
+
+ private:
+  bool Validate(const std::vector<ColumnType>& expected_column_types) const;
+
+  // Returns nullptr if there is no |column_type| value at |row| and |column|
+  const uint8_t* GetValue(const size_t row,
+                          const size_t column,
+                          const ColumnType column_type) const;
+
+  const std::vector<ColumnType> column_types_;
+  const std::vector<uint32_t> column_offsets_;
+  const base::span<const uint8_t> data_;
+  const size_t row_count_;
+  const bool is_valid_;
+};
+
+}  // namespace columnar_records
+
+#endif  // BRAVE_COMPONENTS_COLUMNAR_RECORDS_COLUMNAR_RECORDS_H_
@@ -0,0 +1,248 @@
+/* Copyright (c) 2021 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/columnar_records/columnar_records.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/test/gtest_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=ColumnarRecordsTest.*
+
+namespace columnar_records {
+
+class ColumnarRecordsTest : public testing::Test {
+ protected:
+  std::vector<ColumnType> GetColumnTypes() const {
+    return {
+        ColumnType::kString,  // publisher_id
+        ColumnType::kInt,     // visits
+        ColumnType::kInt64,   // duration
+        ColumnType::kDouble,  // score
+        ColumnType::kBool,    // excluded
+        ColumnType::kString   // name
+    };
+  }
+
+  ColumnarRecords BuildRecords() const {
+    ColumnarRecordsBuilder builder(GetColumnTypes());
+
+    builder.AddString("brave.com");
+    builder.AddInt(1);
+    builder.AddInt64(31);
+    builder.AddDouble(1.5);
+    builder.AddBool(true);
+    builder.AddString("");
+
+    builder.AddString("duckduckgo.com");
+    builder.AddInt(-2);
+    builder.AddInt64(-1);
+    builder.AddDouble(0.0);
+    builder.AddBool(false);
+    builder.AddString("DuckDuckGo");
+
+    return builder.Build();
+  }
+
+  // Overwrites the |index|th string offset of the string column starting at
+  // |column_offset|.
+  void SetStringOffset(ColumnarRecords* records,
+                       const size_t column_offset,
+                       const size_t index,
+                       const uint32_t string_offset) const {
+    memcpy(records->data.data() + column_offset + index * sizeof(uint32_t),
+           &string_offset, sizeof(string_offset));
+  }
+};
+
+TEST_F(ColumnarRecordsTest, ReadRecords) {
+  const ColumnarRecords columnar_records = BuildRecords();
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  ASSERT_TRUE(records.is_valid());
+  ASSERT_EQ(2UL, records.row_count());
+
+  EXPECT_EQ("brave.com", records.ColumnString(0, 0));
+  EXPECT_EQ(1, records.ColumnInt(0, 1));
+  EXPECT_EQ(31, records.ColumnInt64(0, 2));
+  EXPECT_EQ(1.5, records.ColumnDouble(0, 3));
+  EXPECT_TRUE(records.ColumnBool(0, 4));
+  EXPECT_EQ("", records.ColumnString(0, 5));
+
+  EXPECT_EQ("duckduckgo.com", records.ColumnString(1, 0));
+  EXPECT_EQ(-2, records.ColumnInt(1, 1));
+  EXPECT_EQ(-1, records.ColumnInt64(1, 2));
+  EXPECT_EQ(0.0, records.ColumnDouble(1, 3));
+  EXPECT_FALSE(records.ColumnBool(1, 4));
+  EXPECT_EQ("DuckDuckGo", records.ColumnString(1, 5));
+}
+
+TEST_F(ColumnarRecordsTest, ReadEmptyRecords) {
+  ColumnarRecordsBuilder builder({ColumnType::kString, ColumnType::kInt});
+  const ColumnarRecords columnar_records = builder.Build();
+
+  const ColumnarRecordsReader records(columnar_records,
+                                      {ColumnType::kString, ColumnType::kInt});
+
+  EXPECT_TRUE(records.is_valid());
+  EXPECT_EQ(0UL, records.row_count());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfColumnTypesAreUnexpected) {
+  const ColumnarRecords columnar_records = BuildRecords();
+  std::vector<ColumnType> column_types = GetColumnTypes();
+  column_types.at(1) = ColumnType::kInt64;
+
+  const ColumnarRecordsReader records(columnar_records, column_types);
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfColumnsDoNotMatchOffsets) {
+  ColumnarRecords columnar_records = BuildRecords();
+  columnar_records.column_offsets.pop_back();
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfColumnOffsetIsOutOfBounds) {
+  ColumnarRecords columnar_records = BuildRecords();
+  columnar_records.column_offsets.at(1) =
+      static_cast<uint32_t>(columnar_records.data.size() + 1);
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfStringOffsetsDoNotFit) {
+  ColumnarRecords columnar_records = BuildRecords();
+  // The last string column has no room left for its offsets
+  columnar_records.column_offsets.back() =
+      static_cast<uint32_t>(columnar_records.data.size());
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfRowCountIsTooLarge) {
+  ColumnarRecords columnar_records = BuildRecords();
+  columnar_records.row_count = 1000;
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfStringIsOutOfBounds) {
+  ColumnarRecords columnar_records = BuildRecords();
+  const size_t column_offset = columnar_records.column_offsets.front();
+  SetStringOffset(&columnar_records, column_offset, 2,
+                  static_cast<uint32_t>(columnar_records.data.size()));
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfStringOffsetsDecrease) {
+  ColumnarRecords columnar_records = BuildRecords();
+  const size_t column_offset = columnar_records.column_offsets.front();
+  SetStringOffset(&columnar_records, column_offset, 1, 20);
+  SetStringOffset(&columnar_records, column_offset, 2, 10);
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfStringRunsIntoNextColumn) {
+  ColumnarRecords columnar_records = BuildRecords();
+  const size_t column_offset = columnar_records.column_offsets.at(0);
+  const size_t next_column_offset = columnar_records.column_offsets.at(1);
+  const size_t string_offsets_size = 3 * sizeof(uint32_t);
+  const size_t strings_size =
+      next_column_offset - column_offset - string_offsets_size;
+  SetStringOffset(&columnar_records, column_offset, 2,
+                  static_cast<uint32_t>(strings_size + 1));
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfColumnOffsetsDecrease) {
+  ColumnarRecords columnar_records = BuildRecords();
+  columnar_records.column_offsets.at(1) =
+      columnar_records.column_offsets.at(2) + 1;
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfColumnRunsIntoNextColumn) {
+  ColumnarRecordsBuilder builder({ColumnType::kInt, ColumnType::kInt});
+  builder.AddInt(1);
+  builder.AddInt(2);
+  builder.AddInt(3);
+  builder.AddInt(4);
+  ColumnarRecords columnar_records = builder.Build();
+  // Two int64 values fit the data but not the first column
+  columnar_records.column_types.at(0) = ColumnType::kInt64;
+
+  const ColumnarRecordsReader records(columnar_records,
+                                      columnar_records.column_types);
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, InvalidIfColumnTypeIsWiderThanData) {
+  ColumnarRecordsBuilder builder({ColumnType::kInt});
+  builder.AddInt(1);
+  builder.AddInt(2);
+  ColumnarRecords columnar_records = builder.Build();
+  columnar_records.column_types.at(0) = ColumnType::kInt64;
+
+  const ColumnarRecordsReader records(columnar_records,
+                                      columnar_records.column_types);
+
+  EXPECT_FALSE(records.is_valid());
+}
+
+TEST_F(ColumnarRecordsTest, ReadingColumnAsWrongTypeIsNotAllowed) {
+  const ColumnarRecords columnar_records = BuildRecords();
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+  ASSERT_TRUE(records.is_valid());
+
+  EXPECT_DCHECK_DEATH(records.ColumnInt64(0, 1));
+  EXPECT_DCHECK_DEATH(records.ColumnString(0, 3));
+}
+
+TEST_F(ColumnarRecordsTest, ReadingOutOfBoundsIsNotAllowed) {
+  const ColumnarRecords columnar_records = BuildRecords();
+
+  const ColumnarRecordsReader records(columnar_records, GetColumnTypes());
+  ASSERT_TRUE(records.is_valid());
+
+  EXPECT_DCHECK_DEATH(records.ColumnInt(2, 1));
+  EXPECT_DCHECK_DEATH(records.ColumnInt(0, 6));
+}
+
+TEST_F(ColumnarRecordsTest, AddingValueOfWrongTypeIsNotAllowed) {
+  ColumnarRecordsBuilder builder({ColumnType::kString, ColumnType::kInt});
+
+  EXPECT_DCHECK_DEATH(builder.AddInt(1));
+}
+
+}  // namespace columnar_records
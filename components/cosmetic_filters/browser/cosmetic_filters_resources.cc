@@ -5,85 +5,169 @@
 
 #include "brave/components/cosmetic_filters/browser/cosmetic_filters_resources.h"
 
+#include <string>
 #include <utility>
+#include <vector>
 
-#include "base/json/json_reader.h"
+#include "base/bind.h"
+#include "base/containers/flat_set.h"
 #include "base/optional.h"
+#include "base/stl_util.h"
+#include "base/task/post_task.h"
 #include "base/values.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
+#include "brave/components/cosmetic_filters/browser/cosmetic_resources_cache.h"
+#include "brave/components/cosmetic_filters/browser/hidden_class_id_index.h"
 #include "components/content_settings/core/browser/host_content_settings_map.h"
+#include "url/gurl.h"
 
 namespace cosmetic_filters {
 
+namespace {
+
+std::vector<std::string> ToStringVector(const base::Value* list) {
+  std::vector<std::string> result;
+  if (!list || !list->is_list())
+    return result;
+  result.reserve(list->GetList().size());
+  for (const auto& item : list->GetList()) {
+    if (item.is_string())
+      result.push_back(item.GetString());
+  }
+  return result;
+}
+
+// The adblock engine reports its results as JSON. They're unpacked here once
+// and everything downstream works with the typed struct.
+mojom::CosmeticResourcesPtr ToCosmeticResources(
+    base::Optional<base::Value> value) {
+  if (!value || !value->is_dict())
+    return nullptr;
+
+  auto resources = mojom::CosmeticResources::New();
+  resources->hide_selectors =
+      ToStringVector(value->FindListKey("hide_selectors"));
+  resources->force_hide_selectors =
+      ToStringVector(value->FindListKey("force_hide_selectors"));
+  resources->exceptions = ToStringVector(value->FindListKey("exceptions"));
+  const base::Value* style_selectors = value->FindDictKey("style_selectors");
+  if (style_selectors) {
+    for (const auto& item : style_selectors->DictItems()) {
+      resources->style_selectors[item.first] = ToStringVector(&item.second);
+    }
+  }
+  const std::string* injected_script =
+      value->FindStringKey("injected_script");
+  if (injected_script)
+    resources->injected_script = *injected_script;
+  resources->generichide = value->FindBoolKey("generichide").value_or(false);
+  return resources;
+}
+
+mojom::CosmeticResourcesPtr GetUrlCosmeticResources(
+    brave_shields::AdBlockService* ad_block_service,
+    const std::string& url) {
+  return ToCosmeticResources(ad_block_service->UrlCosmeticResources(url));
+}
+
+std::vector<std::string> GetHiddenClassIdSelectors(
+    brave_shields::AdBlockService* ad_block_service,
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& exceptions) {
+  base::Optional<base::Value> selectors =
+      ad_block_service->HiddenClassIdSelectors(classes, ids, exceptions);
+  return ToStringVector(selectors ? &*selectors : nullptr);
+}
+
+// The index holds selectors queried without exceptions, so the page's
+// exceptions are applied here instead of by the engines.
+std::vector<std::string> RemoveExceptions(
+    std::vector<std::string> selectors,
+    const std::vector<std::string>& exceptions) {
+  if (exceptions.empty())
+    return selectors;
+  const base::flat_set<std::string> exception_set(exceptions);
+  base::EraseIf(selectors, [&](const std::string& selector) {
+    return exception_set.contains(selector);
+  });
+  return selectors;
+}
+
+}  // namespace
+
 CosmeticFiltersResources::CosmeticFiltersResources(
     HostContentSettingsMap* settings_map,
-    brave_shields::AdBlockService* ad_block_service)
+    brave_shields::AdBlockService* ad_block_service,
+    CosmeticResourcesCache* resources_cache)
     : settings_map_(settings_map),
       ad_block_service_(ad_block_service),
+      resources_cache_(resources_cache),
       weak_factory_(this) {}
 
 CosmeticFiltersResources::~CosmeticFiltersResources() {}
 
 void CosmeticFiltersResources::HiddenClassIdSelectors(
-    const std::string& input,
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
     const std::vector<std::string>& exceptions,
     HiddenClassIdSelectorsCallback callback) {
-  base::Optional<base::Value> input_value = base::JSONReader::Read(input);
-  if (!input_value || !input_value->is_dict()) {
+  if (classes.empty() && ids.empty()) {
     // Nothing to work with
-    std::move(callback).Run(base::Value());
+    std::move(callback).Run(std::vector<std::string>());
 
     return;
   }
-  base::DictionaryValue* input_dict;
-  if (!input_value->GetAsDictionary(&input_dict)) {
-    std::move(callback).Run(base::Value());
 
+  const uint64_t engine_version = ad_block_service_->GetEngineVersion();
+  std::vector<std::string> selectors;
+  std::vector<std::string> unknown_classes;
+  std::vector<std::string> unknown_ids;
+  HiddenClassIdIndex::GetInstance()->Lookup(classes, ids, engine_version,
+                                            &selectors, &unknown_classes,
+                                            &unknown_ids);
+  if (unknown_classes.empty() && unknown_ids.empty()) {
+    std::move(callback).Run(RemoveExceptions(std::move(selectors), exceptions));
     return;
   }
-  std::vector<std::string> classes;
-  base::ListValue* classes_list;
-  if (input_dict->GetList("classes", &classes_list)) {
-    for (size_t i = 0; i < classes_list->GetSize(); i++) {
-      if (!classes_list->GetList()[i].is_string()) {
-        continue;
-      }
-      classes.push_back(classes_list->GetList()[i].GetString());
-    }
-  }
-  std::vector<std::string> ids;
-  base::ListValue* ids_list;
-  if (input_dict->GetList("ids", &ids_list)) {
-    for (size_t i = 0; i < ids_list->GetSize(); i++) {
-      if (!ids_list->GetList()[i].is_string()) {
-        continue;
-      }
-      ids.push_back(ids_list->GetList()[i].GetString());
-    }
-  }
 
-  ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
-      FROM_HERE,
-      base::BindOnce(&brave_shields::AdBlockService::HiddenClassIdSelectors,
-                     base::Unretained(ad_block_service_), classes, ids,
-                     exceptions),
+  // Adblock engines are immutable snapshots, so they can be queried off the
+  // adblock task runner.
+  base::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::ThreadPool(), base::TaskPriority::USER_BLOCKING},
+      base::BindOnce(&GetHiddenClassIdSelectors,
+                     base::Unretained(ad_block_service_), unknown_classes,
+                     unknown_ids, std::vector<std::string>()),
       base::BindOnce(&CosmeticFiltersResources::HiddenClassIdSelectorsOnUI,
-                     weak_factory_.GetWeakPtr(), std::move(callback)));
+                     weak_factory_.GetWeakPtr(), std::move(unknown_classes),
+                     std::move(unknown_ids), engine_version, exceptions,
+                     std::move(selectors), std::move(callback)));
 }
 
 void CosmeticFiltersResources::HiddenClassIdSelectorsOnUI(
+    const std::vector<std::string>& classes,
+    const std::vector<std::string>& ids,
+    uint64_t engine_version,
+    const std::vector<std::string>& exceptions,
+    std::vector<std::string> known_selectors,
     HiddenClassIdSelectorsCallback callback,
-    base::Optional<base::Value> resources) {
-  std::move(callback).Run(resources ? std::move(resources.value())
-                                    : base::Value());
+    std::vector<std::string> selectors) {
+  HiddenClassIdIndex::GetInstance()->Add(classes, ids, engine_version,
+                                         selectors);
+  known_selectors.insert(known_selectors.end(), selectors.begin(),
+                         selectors.end());
+  std::move(callback).Run(
+      RemoveExceptions(std::move(known_selectors), exceptions));
 }
 
 void CosmeticFiltersResources::UrlCosmeticResourcesOnUI(
+    const std::string& url,
+    uint64_t engine_version,
     UrlCosmeticResourcesCallback callback,
-    base::Optional<base::Value> resources) {
-  std::move(callback).Run(resources ? std::move(resources.value())
-                                    : base::Value());
+    mojom::CosmeticResourcesPtr resources) {
+  resources_cache_->Put(url, engine_version, resources);
+  std::move(callback).Run(std::move(resources));
 }
 
 void CosmeticFiltersResources::ShouldDoCosmeticFiltering(
@@ -100,12 +184,20 @@ void CosmeticFiltersResources::ShouldDoCosmeticFiltering(
 void CosmeticFiltersResources::UrlCosmeticResources(
     const std::string& url,
     UrlCosmeticResourcesCallback callback) {
-  ad_block_service_->GetTaskRunner()->PostTaskAndReplyWithResult(
-      FROM_HERE,
-      base::BindOnce(&brave_shields::AdBlockService::UrlCosmeticResources,
+  const uint64_t engine_version = ad_block_service_->GetEngineVersion();
+  mojom::CosmeticResourcesPtr resources;
+  if (resources_cache_->Get(url, engine_version, &resources)) {
+    std::move(callback).Run(std::move(resources));
+    return;
+  }
+
+  base::PostTaskAndReplyWithResult(
+      FROM_HERE, {base::ThreadPool(), base::TaskPriority::USER_BLOCKING},
+      base::BindOnce(&GetUrlCosmeticResources,
                      base::Unretained(ad_block_service_), url),
       base::BindOnce(&CosmeticFiltersResources::UrlCosmeticResourcesOnUI,
-                     weak_factory_.GetWeakPtr(), std::move(callback)));
+                     weak_factory_.GetWeakPtr(), url, engine_version,
+                     std::move(callback)));
 }
 
 }  // namespace cosmetic_filters
@@ -11,8 +11,6 @@
 #include <vector>
 
 #include "base/memory/weak_ptr.h"
-#include "base/optional.h"
-#include "base/values.h"
 #include "brave/components/cosmetic_filters/common/cosmetic_filters.mojom.h"
 
 class HostContentSettingsMap;
@@ -23,6 +21,8 @@ class AdBlockService;
 
 namespace cosmetic_filters {
 
+class CosmeticResourcesCache;
+
 // CosmeticFiltersResources is a class that is responsible for interaction
 // between CosmeticFiltersJSHandler class that lives inside renderer process.
 
@@ -32,7 +32,8 @@ class CosmeticFiltersResources final
   CosmeticFiltersResources(const CosmeticFiltersResources&) = delete;
   CosmeticFiltersResources& operator=(const CosmeticFiltersResources&) = delete;
   CosmeticFiltersResources(HostContentSettingsMap* settings_map,
-                           brave_shields::AdBlockService* ad_block_service);
+                           brave_shields::AdBlockService* ad_block_service,
+                           CosmeticResourcesCache* resources_cache);
   ~CosmeticFiltersResources() override;
 
   // Sends back to renderer a response: do we need to apply cosmetic filters
@@ -43,7 +44,8 @@ class CosmeticFiltersResources final
 
   // Sends back to renderer a response about rules that has to be applied
   // for the specified selectors.
-  void HiddenClassIdSelectors(const std::string& input,
+  void HiddenClassIdSelectors(const std::vector<std::string>& classes,
+                              const std::vector<std::string>& ids,
                               const std::vector<std::string>& exceptions,
                               HiddenClassIdSelectorsCallback callback) override;
 
@@ -53,14 +55,22 @@ class CosmeticFiltersResources final
                             UrlCosmeticResourcesCallback callback) override;
 
  private:
-  void HiddenClassIdSelectorsOnUI(HiddenClassIdSelectorsCallback callback,
-                                  base::Optional<base::Value> resources);
-
-  void UrlCosmeticResourcesOnUI(UrlCosmeticResourcesCallback callback,
-                                base::Optional<base::Value> resources);
+  void HiddenClassIdSelectorsOnUI(const std::vector<std::string>& classes,
+                                  const std::vector<std::string>& ids,
+                                  uint64_t engine_version,
+                                  const std::vector<std::string>& exceptions,
+                                  std::vector<std::string> known_selectors,
+                                  HiddenClassIdSelectorsCallback callback,
+                                  std::vector<std::string> selectors);
+
+  void UrlCosmeticResourcesOnUI(const std::string& url,
+                                uint64_t engine_version,
+                                UrlCosmeticResourcesCallback callback,
+                                mojom::CosmeticResourcesPtr resources);
 
   HostContentSettingsMap* settings_map_;             // Not owned
   brave_shields::AdBlockService* ad_block_service_;  // Not owned
+  CosmeticResourcesCache* resources_cache_;          // Not owned
 
   base::WeakPtrFactory<CosmeticFiltersResources> weak_factory_;
 };
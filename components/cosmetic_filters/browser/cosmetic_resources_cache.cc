@@ -0,0 +1,51 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/cosmetic_filters/browser/cosmetic_resources_cache.h"
+
+#include "base/metrics/histogram_macros.h"
+
+namespace cosmetic_filters {
+
+CosmeticResourcesCache::CosmeticResourcesCache(size_t max_size)
+    : cache_(max_size) {}
+
+CosmeticResourcesCache::~CosmeticResourcesCache() = default;
+
+bool CosmeticResourcesCache::Get(const std::string& url,
+                                 uint64_t engine_version,
+                                 mojom::CosmeticResourcesPtr* resources) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  MaybeInvalidate(engine_version);
+
+  auto it = cache_.Get(url);
+  const bool hit = it != cache_.end();
+  UMA_HISTOGRAM_BOOLEAN("Brave.CosmeticFilters.ResourcesCacheHit", hit);
+  if (!hit) {
+    misses_++;
+    return false;
+  }
+
+  hits_++;
+  *resources = it->second.Clone();
+  return true;
+}
+
+void CosmeticResourcesCache::Put(const std::string& url,
+                                 uint64_t engine_version,
+                                 const mojom::CosmeticResourcesPtr& resources) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  MaybeInvalidate(engine_version);
+  cache_.Put(url, resources.Clone());
+}
+
+void CosmeticResourcesCache::MaybeInvalidate(uint64_t engine_version) {
+  if (engine_version == engine_version_)
+    return;
+  cache_.Clear();
+  engine_version_ = engine_version;
+}
+
+}  // namespace cosmetic_filters
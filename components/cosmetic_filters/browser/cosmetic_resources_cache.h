@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_COSMETIC_RESOURCES_CACHE_H_
+#define BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_COSMETIC_RESOURCES_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/containers/mru_cache.h"
+#include "base/sequence_checker.h"
+#include "brave/components/cosmetic_filters/common/cosmetic_filters.mojom.h"
+#include "components/keyed_service/core/keyed_service.h"
+
+namespace cosmetic_filters {
+
+// An LRU cache of the cosmetic resources computed for a URL, so that reloads
+// and frames loading the same document skip the engine lookup. Entries are
+// keyed by the full URL rather than the hostname: hiding rules are per host,
+// but $elemhide and $generichide exceptions are network filters and may only
+// apply to some paths. Entries are tagged with the adblock engine version
+// they were computed against; a lookup with a different version drops the
+// whole cache, so list and tag changes invalidate it automatically.
+//
+// Each profile has its own cache, and so does each incognito profile; it
+// goes away with the profile. Must only be used on the UI thread.
+class CosmeticResourcesCache : public KeyedService {
+ public:
+  static constexpr size_t kDefaultMaxSize = 256;
+
+  explicit CosmeticResourcesCache(size_t max_size = kDefaultMaxSize);
+  CosmeticResourcesCache(const CosmeticResourcesCache&) = delete;
+  CosmeticResourcesCache& operator=(const CosmeticResourcesCache&) = delete;
+  ~CosmeticResourcesCache() override;
+
+  // On a hit, sets |resources| to a copy of the cached entry (which may be
+  // null if the engines had nothing for |url|) and returns true.
+  bool Get(const std::string& url,
+           uint64_t engine_version,
+           mojom::CosmeticResourcesPtr* resources);
+  void Put(const std::string& url,
+           uint64_t engine_version,
+           const mojom::CosmeticResourcesPtr& resources);
+
+  size_t size() const { return cache_.size(); }
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  // Drops all entries if they were computed against another engine version.
+  void MaybeInvalidate(uint64_t engine_version);
+
+  base::MRUCache<std::string, mojom::CosmeticResourcesPtr> cache_;
+  uint64_t engine_version_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace cosmetic_filters
+
+#endif  // BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_COSMETIC_RESOURCES_CACHE_H_
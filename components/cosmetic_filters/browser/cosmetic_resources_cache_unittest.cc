@@ -0,0 +1,68 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/cosmetic_filters/browser/cosmetic_resources_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cosmetic_filters {
+
+TEST(CosmeticResourcesCacheTest, HitsAndMisses) {
+  CosmeticResourcesCache cache(2);
+  mojom::CosmeticResourcesPtr resources;
+  EXPECT_FALSE(cache.Get("https://a.com/", 1, &resources));
+
+  auto a_resources = mojom::CosmeticResources::New();
+  a_resources->hide_selectors.push_back(".ad");
+  cache.Put("https://a.com/", 1, a_resources);
+  // A URL with nothing to apply is cached too.
+  cache.Put("https://b.com/", 1, nullptr);
+
+  ASSERT_TRUE(cache.Get("https://a.com/", 1, &resources));
+  ASSERT_TRUE(resources);
+  EXPECT_EQ(std::vector<std::string>({".ad"}), resources->hide_selectors);
+  ASSERT_TRUE(cache.Get("https://b.com/", 1, &resources));
+  EXPECT_FALSE(resources);
+
+  // a.com is least recently used now, so it's evicted first.
+  cache.Put("https://c.com/", 1, nullptr);
+  EXPECT_FALSE(cache.Get("https://a.com/", 1, &resources));
+  EXPECT_TRUE(cache.Get("https://c.com/", 1, &resources));
+
+  EXPECT_EQ(3u, cache.hits());
+  EXPECT_EQ(2u, cache.misses());
+}
+
+TEST(CosmeticResourcesCacheTest, EngineVersionChangeInvalidates) {
+  CosmeticResourcesCache cache;
+  mojom::CosmeticResourcesPtr resources;
+  cache.Put("https://a.com/", 1, mojom::CosmeticResources::New());
+  cache.Put("https://b.com/", 1, mojom::CosmeticResources::New());
+  EXPECT_EQ(2u, cache.size());
+
+  EXPECT_FALSE(cache.Get("https://a.com/", 2, &resources));
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Get("https://b.com/", 1, &resources));
+}
+
+TEST(CosmeticResourcesCacheTest, KeyedByFullURL) {
+  CosmeticResourcesCache cache;
+  mojom::CosmeticResourcesPtr resources;
+  // An $elemhide exception may only cover some paths of a site, so other
+  // pages of the same host don't share the entry.
+  cache.Put("https://a.com/excepted/", 1, nullptr);
+  cache.Put("https://a.com/", 1, mojom::CosmeticResources::New());
+
+  ASSERT_TRUE(cache.Get("https://a.com/excepted/", 1, &resources));
+  EXPECT_FALSE(resources);
+  ASSERT_TRUE(cache.Get("https://a.com/", 1, &resources));
+  EXPECT_TRUE(resources);
+  EXPECT_FALSE(cache.Get("https://a.com/other/", 1, &resources));
+}
+
+}  // namespace cosmetic_filters
@@ -0,0 +1,155 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/cosmetic_filters/browser/hidden_class_id_index.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "base/no_destructor.h"
+#include "base/strings/string_util.h"
+#include "base/strings/utf_string_conversion_utils.h"
+
+namespace cosmetic_filters {
+
+namespace {
+
+std::string ClassKey(const std::string& class_name) {
+  return "." + class_name;
+}
+
+std::string IdKey(const std::string& id) {
+  return "#" + id;
+}
+
+bool IsIdentifierChar(char c) {
+  return base::IsAsciiAlpha(c) || base::IsAsciiDigit(c) || c == '-' ||
+         c == '_' || static_cast<unsigned char>(c) >= 0x80;
+}
+
+// Consumes the CSS escape starting at the backslash at |*pos| and appends
+// the character it stands for to |output|. Returns false if there's no valid
+// escape at |*pos|.
+bool ConsumeEscape(const std::string& selector,
+                   size_t* pos,
+                   std::string* output) {
+  size_t i = *pos + 1;
+  if (i >= selector.size() || selector[i] == '\n' || selector[i] == '\r' ||
+      selector[i] == '\f') {
+    return false;
+  }
+
+  if (!base::IsHexDigit(selector[i])) {
+    // Any other character stands for itself. Non-ASCII characters need no
+    // special handling since their remaining bytes are identifier chars.
+    output->push_back(selector[i]);
+    *pos = i + 1;
+    return true;
+  }
+
+  uint32_t code_point = 0;
+  const size_t end = std::min(selector.size(), i + 6);
+  for (; i < end && base::IsHexDigit(selector[i]); ++i)
+    code_point = code_point * 16 + base::HexDigitToInt(selector[i]);
+  // A single whitespace terminates a hex escape and is part of it.
+  if (i < selector.size() && base::IsAsciiWhitespace(selector[i]))
+    ++i;
+  if (code_point == 0 || !base::IsValidCodepoint(code_point))
+    code_point = 0xFFFD;
+  base::WriteUnicodeCharacter(code_point, output);
+  *pos = i;
+  return true;
+}
+
+// Returns the class name or id |selector| starts with, unescaped and
+// prefixed with "." or "#", or an empty string if it doesn't start with one.
+std::string LeadingSimpleSelector(const std::string& selector) {
+  if (selector.empty() || (selector[0] != '.' && selector[0] != '#'))
+    return std::string();
+  std::string result(1, selector[0]);
+  size_t pos = 1;
+  while (pos < selector.size()) {
+    if (selector[pos] == '\\') {
+      if (!ConsumeEscape(selector, &pos, &result))
+        return std::string();
+    } else if (IsIdentifierChar(selector[pos])) {
+      result.push_back(selector[pos++]);
+    } else {
+      break;
+    }
+  }
+  return result.size() > 1 ? result : std::string();
+}
+
+}  // namespace
+
+HiddenClassIdIndex::HiddenClassIdIndex(size_t max_size) : entries_(max_size) {}
+
+HiddenClassIdIndex::~HiddenClassIdIndex() = default;
+
+// static
+HiddenClassIdIndex* HiddenClassIdIndex::GetInstance() {
+  static base::NoDestructor<HiddenClassIdIndex> instance;
+  return instance.get();
+}
+
+void HiddenClassIdIndex::Lookup(const std::vector<std::string>& classes,
+                                const std::vector<std::string>& ids,
+                                uint64_t engine_version,
+                                std::vector<std::string>* selectors,
+                                std::vector<std::string>* unknown_classes,
+                                std::vector<std::string>* unknown_ids) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  MaybeInvalidate(engine_version);
+
+  auto lookup = [&](const std::string& key, const std::string& value,
+                    std::vector<std::string>* unknown) {
+    auto it = entries_.Get(key);
+    if (it == entries_.end()) {
+      unknown->push_back(value);
+      return;
+    }
+    selectors->insert(selectors->end(), it->second.begin(), it->second.end());
+  };
+
+  for (const auto& class_name : classes)
+    lookup(ClassKey(class_name), class_name, unknown_classes);
+  for (const auto& id : ids)
+    lookup(IdKey(id), id, unknown_ids);
+}
+
+void HiddenClassIdIndex::Add(const std::vector<std::string>& classes,
+                             const std::vector<std::string>& ids,
+                             uint64_t engine_version,
+                             const std::vector<std::string>& selectors) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  MaybeInvalidate(engine_version);
+
+  std::map<std::string, std::vector<std::string>> batch;
+  for (const auto& class_name : classes)
+    batch[ClassKey(class_name)];
+  for (const auto& id : ids)
+    batch[IdKey(id)];
+
+  for (const auto& selector : selectors) {
+    auto it = batch.find(LeadingSimpleSelector(selector));
+    if (it == batch.end())
+      return;
+    it->second.push_back(selector);
+  }
+
+  for (auto& entry : batch)
+    entries_.Put(entry.first, std::move(entry.second));
+}
+
+void HiddenClassIdIndex::MaybeInvalidate(uint64_t engine_version) {
+  if (engine_version == engine_version_)
+    return;
+  entries_.Clear();
+  engine_version_ = engine_version;
+}
+
+}  // namespace cosmetic_filters
@@ -0,0 +1,72 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_HIDDEN_CLASS_ID_INDEX_H_
+#define BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_HIDDEN_CLASS_ID_INDEX_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/containers/mru_cache.h"
+#include "base/sequence_checker.h"
+
+namespace cosmetic_filters {
+
+// Remembers which generic hiding selectors the adblock engines returned for
+// each class and id, so that classes and ids seen on earlier pages are
+// answered without another trip to the engines. Classes and ids that have no
+// selectors, which is nearly all of them, are remembered too. Like
+// CosmeticResourcesCache, everything is dropped when the engine version
+// changes.
+class HiddenClassIdIndex {
+ public:
+  static constexpr size_t kDefaultMaxSize = 8192;
+
+  explicit HiddenClassIdIndex(size_t max_size = kDefaultMaxSize);
+  HiddenClassIdIndex(const HiddenClassIdIndex&) = delete;
+  HiddenClassIdIndex& operator=(const HiddenClassIdIndex&) = delete;
+  ~HiddenClassIdIndex();
+
+  // Shared by all frames. Must only be used on the UI thread.
+  static HiddenClassIdIndex* GetInstance();
+
+  // Appends the known selectors for |classes| and |ids| to |selectors|, and
+  // the classes and ids the index knows nothing about to |unknown_classes|
+  // and |unknown_ids|.
+  void Lookup(const std::vector<std::string>& classes,
+              const std::vector<std::string>& ids,
+              uint64_t engine_version,
+              std::vector<std::string>* selectors,
+              std::vector<std::string>* unknown_classes,
+              std::vector<std::string>* unknown_ids);
+
+  // Records the |selectors| the engines returned for |classes| and |ids|,
+  // queried without exceptions. Each selector is attributed to the class or
+  // id it starts with, with CSS escapes resolved, so ".a\:b" belongs to the
+  // class "a:b". If any selector can't be attributed, nothing from the batch
+  // is recorded and its classes and ids are queried again next time.
+  void Add(const std::vector<std::string>& classes,
+           const std::vector<std::string>& ids,
+           uint64_t engine_version,
+           const std::vector<std::string>& selectors);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  // Drops all entries if they were computed against another engine version.
+  void MaybeInvalidate(uint64_t engine_version);
+
+  // Keyed by the simple selector for the class or id, e.g. ".ad" or "#ad".
+  base::MRUCache<std::string, std::vector<std::string>> entries_;
+  uint64_t engine_version_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace cosmetic_filters
+
+#endif  // BRAVE_COMPONENTS_COSMETIC_FILTERS_BROWSER_HIDDEN_CLASS_ID_INDEX_H_
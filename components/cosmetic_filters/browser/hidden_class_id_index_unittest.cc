@@ -0,0 +1,75 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/cosmetic_filters/browser/hidden_class_id_index.h"
+
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace cosmetic_filters {
+
+TEST(HiddenClassIdIndexTest, AnswersFromEarlierBatches) {
+  HiddenClassIdIndex index;
+  index.Add({"ad", "ad-banner", "content"}, {"sponsored"}, 1,
+            {".ad", ".ad > div", ".ad-banner", "#sponsored"});
+
+  std::vector<std::string> selectors;
+  std::vector<std::string> unknown_classes;
+  std::vector<std::string> unknown_ids;
+  index.Lookup({"ad", "content", "new"}, {"sponsored", "ad"}, 1, &selectors,
+               &unknown_classes, &unknown_ids);
+  EXPECT_EQ(std::vector<std::string>({".ad", ".ad > div", "#sponsored"}),
+            selectors);
+  EXPECT_EQ(std::vector<std::string>({"new"}), unknown_classes);
+  EXPECT_EQ(std::vector<std::string>({"ad"}), unknown_ids);
+}
+
+TEST(HiddenClassIdIndexTest, UnattributableSelectorsSkipTheBatch) {
+  HiddenClassIdIndex index;
+  index.Add({"ad"}, {}, 1, {".ad", "div.ad"});
+  EXPECT_EQ(0u, index.size());
+}
+
+TEST(HiddenClassIdIndexTest, AttributesEscapedSelectors) {
+  HiddenClassIdIndex index;
+  index.Add({"a:b", "sm:hidden"}, {"123", "x.y"}, 1,
+            {".a\\:b", ".sm\\:hidden > span", "#\\31 23", "#x\\.y"});
+  EXPECT_EQ(4u, index.size());
+
+  std::vector<std::string> selectors;
+  std::vector<std::string> unknown_classes;
+  std::vector<std::string> unknown_ids;
+  index.Lookup({"a:b", "sm:hidden"}, {"123", "x.y"}, 1, &selectors,
+               &unknown_classes, &unknown_ids);
+  EXPECT_EQ(std::vector<std::string>({".a\\:b", ".sm\\:hidden > span",
+                                      "#\\31 23", "#x\\.y"}),
+            selectors);
+  EXPECT_TRUE(unknown_classes.empty());
+  EXPECT_TRUE(unknown_ids.empty());
+}
+
+TEST(HiddenClassIdIndexTest, InvalidEscapeSkipsTheBatch) {
+  HiddenClassIdIndex index;
+  index.Add({"a"}, {}, 1, {".a", ".a\\"});
+  EXPECT_EQ(0u, index.size());
+}
+
+TEST(HiddenClassIdIndexTest, EngineVersionChangeInvalidates) {
+  HiddenClassIdIndex index;
+  index.Add({"ad"}, {}, 1, {".ad"});
+  EXPECT_EQ(1u, index.size());
+
+  std::vector<std::string> selectors;
+  std::vector<std::string> unknown_classes;
+  std::vector<std::string> unknown_ids;
+  index.Lookup({"ad"}, {}, 2, &selectors, &unknown_classes, &unknown_ids);
+  EXPECT_TRUE(selectors.empty());
+  EXPECT_EQ(std::vector<std::string>({"ad"}), unknown_classes);
+  EXPECT_EQ(0u, index.size());
+}
+
+}  // namespace cosmetic_filters
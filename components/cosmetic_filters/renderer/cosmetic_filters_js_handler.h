@@ -48,12 +48,13 @@ class CosmeticFiltersJSHandler {
   void CreateWorkerObject(v8::Isolate* isolate, v8::Local<v8::Context> context);
 
   // A function to be called from JS
-  void HiddenClassIdSelectors(const std::string& input);
+  void HiddenClassIdSelectors(const std::vector<std::string>& classes,
+                              const std::vector<std::string>& ids);
 
   void OnShouldDoCosmeticFiltering(bool enabled, bool first_party_enabled);
-  void OnUrlCosmeticResources(base::Value result);
-  void CSSRulesRoutine(base::DictionaryValue* resources_dict);
-  void OnHiddenClassIdSelectors(base::Value result);
+  void OnUrlCosmeticResources(mojom::CosmeticResourcesPtr resources);
+  void CSSRulesRoutine(const mojom::CosmeticResources& resources);
+  void OnHiddenClassIdSelectors(const std::vector<std::string>& selectors);
 
   content::RenderFrame* render_frame_;
   mojo::Remote<cosmetic_filters::mojom::CosmeticFiltersResources>
@@ -21,12 +21,21 @@ const maxTimeMSBeforeStart = 2500
 const minAdTextChars = 30
 const minAdTextWords = 5
 
+// Classes and ids are sent to the browser in batches of at most this many
+// items, and a partial batch is held back at most this long so that bursts
+// of DOM mutations are coalesced into a single request.
+const maxClassIdBatchSize = 500
+const classIdFlushDelayMs = 100
+
+// Classes and ids already sent to the browser. These are exact so that no
+// class or id is ever skipped; the browser remembers the answers for
+// repeated names across pages.
 const queriedIds = new Set<string>()
 const queriedClasses = new Set<string>()
 
-// Each of these get setup once the mutation observer starts running.
-let notYetQueriedClasses: string[]
-let notYetQueriedIds: string[]
+let notYetQueriedClasses: string[] = []
+let notYetQueriedIds: string[] = []
+let classIdFlushTimeoutId: number | undefined = undefined
 let cosmeticObserver: MutationObserver | undefined = undefined
 
 window.content_cosmetic = window.content_cosmetic || {}
@@ -95,20 +104,51 @@ const asHTMLElement = (node: Node): HTMLElement | null => {
 }
 
 const fetchNewClassIdRules = () => {
-  if ((!notYetQueriedClasses || notYetQueriedClasses.length === 0) &&
-    (!notYetQueriedIds || notYetQueriedIds.length === 0)) {
+  if (classIdFlushTimeoutId !== undefined) {
+    window.clearTimeout(classIdFlushTimeoutId)
+    classIdFlushTimeoutId = undefined
+  }
+  if (notYetQueriedClasses.length === 0 && notYetQueriedIds.length === 0) {
     return
   }
   // Callback to c++ renderer process
   // @ts-ignore
-  cf_worker.hiddenClassIdSelectors(
-      JSON.stringify({
-        classes: notYetQueriedClasses, ids: notYetQueriedIds
-      }))
+  cf_worker.hiddenClassIdSelectors(notYetQueriedClasses, notYetQueriedIds)
   notYetQueriedClasses = []
   notYetQueriedIds = []
 }
 
+/**
+ * Sends the pending classes and ids right away once there's a full batch of
+ * them, otherwise waits a little for more mutations to arrive.
+ */
+const scheduleFetchNewClassIdRules = () => {
+  const pendingCount = notYetQueriedClasses.length + notYetQueriedIds.length
+  if (pendingCount >= maxClassIdBatchSize) {
+    fetchNewClassIdRules()
+    return
+  }
+  if (pendingCount === 0 || classIdFlushTimeoutId !== undefined) {
+    return
+  }
+  classIdFlushTimeoutId =
+    window.setTimeout(fetchNewClassIdRules, classIdFlushDelayMs)
+}
+
+const queueClass = (className: string) => {
+  if (className && !queriedClasses.has(className)) {
+    queriedClasses.add(className)
+    notYetQueriedClasses.push(className)
+  }
+}
+
+const queueId = (id: string) => {
+  if (id && !queriedIds.has(id)) {
+    queriedIds.add(id)
+    notYetQueriedIds.push(id)
+  }
+}
+
 const handleMutations: MutationCallback = (mutations: MutationRecord[]) => {
   for (const aMutation of mutations) {
     if (aMutation.type === 'attributes') {
@@ -118,19 +158,12 @@ const handleMutations: MutationCallback = (mutations: MutationRecord[]) => {
       switch (aMutation.attributeName) {
         case 'class':
           for (const aClassName of changedElm.classList.values()) {
-            if (queriedClasses.has(aClassName) === false) {
-              notYetQueriedClasses.push(aClassName)
-              queriedClasses.add(aClassName)
-            }
+            queueClass(aClassName)
           }
           break
 
         case 'id':
-          const mutatedId = changedElm.id
-          if (queriedIds.has(mutatedId) === false) {
-            notYetQueriedIds.push(mutatedId)
-            queriedIds.add(mutatedId)
-          }
+          queueId(changedElm.id)
           break
       }
     } else if (aMutation.addedNodes.length > 0) {
@@ -139,25 +172,18 @@ const handleMutations: MutationCallback = (mutations: MutationRecord[]) => {
         if (!element) {
           continue
         }
-        const id = element.id
-        if (id && !queriedIds.has(id)) {
-          notYetQueriedIds.push(id)
-          queriedIds.add(id)
-        }
+        queueId(element.id)
         const classList = element.classList
         if (classList) {
           for (const className of classList.values()) {
-            if (className && !queriedClasses.has(className)) {
-              notYetQueriedClasses.push(className)
-              queriedClasses.add(className)
-            }
+            queueClass(className)
           }
         }
       }
     }
   }
 
-  fetchNewClassIdRules()
+  scheduleFetchNewClassIdRules()
 }
 
 const _parseDomainCache = Object.create(null)
@@ -516,16 +542,13 @@ const startObserving = () => {
   const elmWithClassOrId = document.querySelectorAll('[class],[id]')
   for (const elm of elmWithClassOrId) {
     for (const aClassName of elm.classList.values()) {
-      queriedClasses.add(aClassName)
+      queueClass(aClassName)
     }
     const elmId = elm.getAttribute('id')
     if (elmId) {
-      queriedIds.add(elmId)
+      queueId(elmId)
     }
   }
-
-  notYetQueriedClasses = Array.from(queriedClasses)
-  notYetQueriedIds = Array.from(queriedIds)
   fetchNewClassIdRules()
 
   // Second, set up a mutation observer to handle any new ids or classes
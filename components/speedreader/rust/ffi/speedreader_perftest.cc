@@ -0,0 +1,160 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/rust/ffi/speedreader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "base/timer/elapsed_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace speedreader {
+
+namespace {
+
+constexpr char kTestConfig[] = R"(
+[
+    {
+        "domain": "example.com",
+        "url_rules": [
+            "||example.com/*/article/"
+        ],
+        "declarative_rewrite": {
+            "main_content": [
+                ".article-title",
+                ".article-body"
+            ],
+            "main_content_cleanup": [
+                ".hidden"
+            ],
+            "delazify": true,
+            "fix_embeds": false,
+            "content_script": null,
+            "preprocess": []
+        }
+    }
+]
+)";
+
+constexpr char kArticleURL[] =
+    "https://example.com/news/article/topic/index.html";
+// Matches what SpeedReaderURLLoader reads from the network at a time.
+constexpr size_t kChunkSize = 32768;
+constexpr int kParagraphs = 20000;
+
+constexpr char kMetricPrefix[] = "SpeedReader.";
+constexpr char kMetricTimeToFirstByte[] = "time_to_first_byte";
+constexpr char kMetricTotalTime[] = "total_time";
+constexpr char kMetricPeakBufferedBytes[] = "peak_buffered_bytes";
+
+// A few MB of article with some page chrome around it.
+std::string MakeLargeArticle() {
+  std::string page =
+      "<html><head><title>Article</title></head><body>"
+      "<nav class=\"hidden\">menu</nav>"
+      "<h1 class=\"article-title\">A very long read</h1>"
+      "<div class=\"article-body\">";
+  for (int i = 0; i < kParagraphs; ++i) {
+    page += base::StringPrintf(
+        "<p>Paragraph %d. Lorem ipsum dolor sit amet, consectetur adipiscing "
+        "elit, sed do eiusmod tempor incididunt ut labore et dolore magna "
+        "aliqua. <img data-src=\"/img/%d.jpg\"></p>"
+        "<div class=\"hidden\">ad slot %d</div>",
+        i, i, i);
+  }
+  page += "</div></body></html>";
+  return page;
+}
+
+struct OutputStats {
+  base::ElapsedTimer timer;
+  base::TimeDelta time_to_first_byte;
+  bool got_output = false;
+  // Output produced but not yet handed to the consumer.
+  size_t pending_bytes = 0;
+};
+
+void CollectOutput(const char* chunk, size_t chunk_len, void* user_data) {
+  OutputStats* stats = static_cast<OutputStats*>(user_data);
+  if (!stats->got_output && chunk_len > 0) {
+    stats->got_output = true;
+    stats->time_to_first_byte = stats->timer.Elapsed();
+  }
+  stats->pending_bytes += chunk_len;
+}
+
+void Report(const std::string& story,
+            base::TimeDelta time_to_first_byte,
+            base::TimeDelta total_time,
+            size_t peak_buffered_bytes) {
+  perf_test::PerfResultReporter reporter(kMetricPrefix, story);
+  reporter.RegisterImportantMetric(kMetricTimeToFirstByte, "ms");
+  reporter.RegisterImportantMetric(kMetricTotalTime, "ms");
+  reporter.RegisterImportantMetric(kMetricPeakBufferedBytes, "bytes");
+  reporter.AddResult(kMetricTimeToFirstByte, time_to_first_byte);
+  reporter.AddResult(kMetricTotalTime, total_time);
+  reporter.AddResult(kMetricPeakBufferedBytes, peak_buffered_bytes);
+}
+
+class SpeedReaderPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(sr_.deserialize(kTestConfig, strlen(kTestConfig)));
+    page_ = MakeLargeArticle();
+  }
+
+  SpeedReader sr_;
+  std::string page_;
+};
+
+}  // namespace
+
+// What SpeedReaderURLLoader used to do: buffer the whole body, rewrite it in
+// one go and only then start sending.
+TEST_F(SpeedReaderPerfTest, Buffered) {
+  OutputStats stats;
+  std::string body;
+  for (size_t offset = 0; offset < page_.size(); offset += kChunkSize)
+    body.append(page_, offset, kChunkSize);
+
+  auto rewriter = sr_.MakeRewriter(kArticleURL);
+  ASSERT_EQ(0, rewriter->Write(body.data(), body.size()));
+  ASSERT_EQ(0, rewriter->End());
+  const size_t output_size = rewriter->GetOutput().size();
+  // Nothing reaches the page before the rewriter is done.
+  const base::TimeDelta total_time = stats.timer.Elapsed();
+  ASSERT_GT(output_size, 0u);
+
+  Report("buffered", total_time, total_time, body.size() + output_size);
+}
+
+// Chunks are rewritten as they arrive and output is forwarded right away.
+TEST_F(SpeedReaderPerfTest, Streaming) {
+  OutputStats stats;
+  size_t peak_buffered_bytes = 0;
+  auto rewriter = sr_.MakeRewriter(kArticleURL, RewriterType::RewriterStreaming,
+                                   &CollectOutput, &stats);
+  for (size_t offset = 0; offset < page_.size(); offset += kChunkSize) {
+    const size_t len = std::min(kChunkSize, page_.size() - offset);
+    ASSERT_EQ(0, rewriter->Write(page_.data() + offset, len));
+    peak_buffered_bytes =
+        std::max(peak_buffered_bytes, len + stats.pending_bytes);
+    // The loader writes the output to the destination pipe here.
+    stats.pending_bytes = 0;
+  }
+  ASSERT_EQ(0, rewriter->End());
+  peak_buffered_bytes = std::max(peak_buffered_bytes, stats.pending_bytes);
+  const base::TimeDelta total_time = stats.timer.Elapsed();
+  ASSERT_TRUE(stats.got_output);
+
+  Report("streaming", stats.time_to_first_byte, total_time,
+         peak_buffered_bytes);
+}
+
+}  // namespace speedreader
@@ -7,8 +7,10 @@ use crate::speedreader::RewriteRules;
 use crate::speedreader::SpeedReaderError;
 
 pub type HandlerResult = Result<(), Box<dyn Error>>;
-pub type ElementHandler = Box<dyn Fn(&mut Element) -> HandlerResult>;
-pub type TextHandler = Box<dyn Fn(&mut TextChunk) -> HandlerResult>;
+// Handlers are compiled once per domain and shared by rewriters running on
+// different threads, so they must be thread-safe.
+pub type ElementHandler = Box<dyn Fn(&mut Element) -> HandlerResult + Send + Sync>;
+pub type TextHandler = Box<dyn Fn(&mut TextChunk) -> HandlerResult + Send + Sync>;
 
 pub struct ContentFunction {
     pub element: Option<ElementHandler>,
@@ -35,10 +37,9 @@ impl From<TextHandler> for ContentFunction {
     }
 }
 
-pub fn rewrite_rules_to_content_handlers(
-    conf: &RewriteRules,
-    _origin: &str,
-) -> Vec<(Selector, ContentFunction)> {
+/// Builds the handlers for a domain's rewrite rules. They must not depend on
+/// the article URL, as they are reused for every page on the domain.
+pub fn rewrite_rules_to_content_handlers(conf: &RewriteRules) -> Vec<(Selector, ContentFunction)> {
     let mut element_content_handlers = vec![];
     let mut errors = vec![];
 
@@ -1,6 +1,8 @@
 use lol_html::Selector;
 use serde::{Deserialize, Serialize};
 use core::any::Any;
+use std::collections::HashMap;
+use std::sync::Arc;
 use thiserror::Error;
 use url::Url;
 
@@ -129,9 +131,11 @@ pub struct RewriteRules {
     pub preprocess: Vec<AttributeRewrite>,
 }
 
+pub type ContentHandlers = Vec<(Selector, ContentFunction)>;
+
 impl RewriteRules {
-    pub fn get_content_handlers(&self, url: &Url) -> Vec<(Selector, ContentFunction)> {
-        rewrite_rules_to_content_handlers(self, &url.origin().ascii_serialization())
+    pub fn get_content_handlers(&self) -> ContentHandlers {
+        rewrite_rules_to_content_handlers(self)
     }
 }
 
@@ -150,25 +154,35 @@ impl RewriteRules {
 pub struct SpeedReader {
     whitelist: Whitelist,
     url_engine: adblock::engine::Engine,
+    /// Content handlers of every domain with declarative rewrite rules, keyed
+    /// by the configured domain. Compiled when the whitelist is loaded and
+    /// shared by all rewriters for the domain.
+    compiled_handlers: HashMap<String, Arc<ContentHandlers>>,
+    empty_handlers: Arc<ContentHandlers>,
 }
 
 impl Default for SpeedReader {
     fn default() -> Self {
-        let whitelist = Whitelist::default();
-        let url_engine = adblock::engine::Engine::from_rules(&whitelist.get_url_rules());
-        SpeedReader {
-            whitelist,
-            url_engine,
-        }
+        SpeedReader::with_whitelist(Whitelist::default())
     }
 }
 
 impl SpeedReader {
     pub fn with_whitelist(whitelist: Whitelist) -> Self {
         let url_engine = adblock::engine::Engine::from_rules(&whitelist.get_url_rules());
+        let compiled_handlers = whitelist
+            .configurations()
+            .filter_map(|config| {
+                config.declarative_rewrite.as_ref().map(|rewrite| {
+                    (config.domain.clone(), Arc::new(rewrite.get_content_handlers()))
+                })
+            })
+            .collect();
         SpeedReader {
             whitelist,
             url_engine,
+            compiled_handlers,
+            empty_handlers: Arc::new(vec![]),
         }
     }
 
@@ -202,22 +216,19 @@ impl SpeedReader {
         }
     }
 
+    /// Returns the precompiled content handlers for the article's domain,
+    /// boxed for passing through the FFI. Cheap: no selectors are parsed.
     pub fn get_opaque_config(&self, article_url: &str) -> Box<dyn Any> {
-        if let Ok(url) = Url::parse(article_url) {
-            let config = self
-                .whitelist
-                .get_configuration(&url.domain().unwrap_or_default());
-
-            match config {
-                Some(SpeedReaderConfig {
-                    declarative_rewrite: Some(rewrite),
-                    ..
-                }) => Box::new(rewrite.get_content_handlers(&url)),
-                _ => Box::new(Vec::<(Selector, ContentFunction)>::new()),
-            }
-        } else {
-            Box::new(Vec::<(Selector, ContentFunction)>::new())
-        }
+        let handlers = Url::parse(article_url)
+            .ok()
+            .and_then(|url| {
+                self.whitelist
+                    .get_configuration(&url.domain().unwrap_or_default())
+                    .and_then(|config| self.compiled_handlers.get(&config.domain))
+                    .cloned()
+            })
+            .unwrap_or_else(|| self.empty_handlers.clone());
+        Box::new(handlers)
     }
 
     pub fn get_rewriter<'h, O: OutputSink + 'h>(
@@ -233,13 +244,12 @@ impl SpeedReader {
                 None => self.get_rewriter_type(article_url),
             };
 
-            if let Some(content_handlers) = extra.downcast_ref::<Vec<(Selector, ContentFunction)>>()
-            {
+            if let Some(content_handlers) = extra.downcast_ref::<Arc<ContentHandlers>>() {
                 match rewriter_decided {
                     RewriterType::Streaming => Ok(Box::new(SpeedReaderStreaming::try_new(
                         url,
                         output_sink,
-                        content_handlers,
+                        content_handlers.as_slice(),
                     )?)),
                     _ => Ok(Box::new(SpeedReaderHeuristics::try_new(
                         url.as_str(),
@@ -336,7 +346,7 @@ mod test {
         assert_eq!(config, RewriterType::Heuristics);
         let opaque = sr.get_opaque_config(article);
         assert!(opaque
-            .downcast_ref::<Vec<(Selector, ContentFunction)>>()
+            .downcast_ref::<Arc<ContentHandlers>>()
             .is_some());
     }
 
@@ -365,4 +375,19 @@ mod test {
         let rewriter = maybe_rewriter.unwrap();
         assert_eq!(rewriter.rewriter_type(), RewriterType::Streaming);
     }
+
+    #[test]
+    pub fn configuration_opaque_compiled_once() {
+        let sr = SpeedReader::with_whitelist(get_whitelist());
+        let first = sr.get_opaque_config("http://example.net/article/today");
+        let second = sr.get_opaque_config("http://www.example.net/article/other");
+        let first = first.downcast_ref::<Arc<ContentHandlers>>().unwrap();
+        let second = second.downcast_ref::<Arc<ContentHandlers>>().unwrap();
+        assert!(!first.is_empty());
+        assert!(Arc::ptr_eq(first, second));
+
+        let heuristics = sr.get_opaque_config("http://example.com/article/today");
+        let heuristics = heuristics.downcast_ref::<Arc<ContentHandlers>>().unwrap();
+        assert!(heuristics.is_empty());
+    }
 }
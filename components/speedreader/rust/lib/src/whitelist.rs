@@ -43,6 +43,10 @@ impl Whitelist {
         None
     }
 
+    pub fn configurations(&self) -> impl Iterator<Item = &SpeedReaderConfig> {
+        self.map.values()
+    }
+
     pub fn get_url_rules(&self) -> Vec<String> {
         self.map
             .values()
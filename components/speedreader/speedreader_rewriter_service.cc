@@ -11,6 +11,7 @@
 #include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/task/post_task.h"
+#include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "brave/components/speedreader/rust/ffi/speedreader.h"
 #include "brave/components/speedreader/speedreader_component.h"
 #include "components/grit/brave_components_resources.h"
@@ -66,11 +67,13 @@ SpeedreaderRewriterService::~SpeedreaderRewriterService() {
 
 void SpeedreaderRewriterService::OnWhitelistReady(const base::FilePath& path) {
   VLOG(2) << "Whitelist ready at " << path;
+  // The DAT data is released on the worker, since unmapping it may block.
   base::PostTaskAndReplyWithResult(
       FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-      base::BindOnce(
-          &brave_component_updater::LoadDATFileData<speedreader::SpeedReader>,
-          path),
+      base::BindOnce(&brave_component_updater::LoadDATFileAndReleaseData<
+                         speedreader::SpeedReader>,
+                     path,
+                     brave_component_updater::GetDefaultDATFileLoadMode()),
       base::BindOnce(&SpeedreaderRewriterService::OnLoadDATFileData,
                      weak_factory_.GetWeakPtr()));
 }
@@ -92,6 +95,20 @@ std::unique_ptr<Rewriter> SpeedreaderRewriterService::MakeRewriter(
   return speedreader_->MakeRewriter(url.spec());
 }
 
+bool SpeedreaderRewriterService::SupportsStreaming(const GURL& url) {
+  return speedreader_->RewriterTypeForURL(url.spec()) ==
+         RewriterType::RewriterStreaming;
+}
+
+std::unique_ptr<Rewriter> SpeedreaderRewriterService::MakeStreamingRewriter(
+    const GURL& url,
+    void (*output_sink)(const char*, size_t, void*),
+    void* output_sink_user_data) {
+  return speedreader_->MakeRewriter(url.spec(),
+                                    RewriterType::RewriterStreaming,
+                                    output_sink, output_sink_user_data);
+}
+
 const std::string& SpeedreaderRewriterService::GetContentStylesheet() {
   return content_stylesheet_;
 }
@@ -102,10 +119,10 @@ void SpeedreaderRewriterService::OnLoadStylesheet(std::string stylesheet) {
 }
 
 void SpeedreaderRewriterService::OnLoadDATFileData(
-    GetDATFileDataResult result) {
+    std::unique_ptr<speedreader::SpeedReader> speedreader) {
   VLOG(2) << "Speedreader loaded from DAT file";
-  if (result.first)
-    speedreader_ = std::move(result.first);
+  if (speedreader)
+    speedreader_ = std::move(speedreader);
 }
 
 }  // namespace speedreader
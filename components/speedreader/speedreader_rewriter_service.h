@@ -11,7 +11,6 @@
 
 #include "base/memory/weak_ptr.h"
 #include "brave/components/brave_component_updater/browser/brave_component.h"
-#include "brave/components/brave_component_updater/browser/dat_file_util.h"
 #include "brave/components/speedreader/speedreader_component.h"
 
 namespace base {
@@ -44,13 +43,19 @@ class SpeedreaderRewriterService : public SpeedreaderComponent::Observer {
   // The API
   bool IsWhitelisted(const GURL& url);
   std::unique_ptr<Rewriter> MakeRewriter(const GURL& url);
+  // Whether |url| is configured for a rewriter that can emit output before it
+  // has seen the whole document.
+  bool SupportsStreaming(const GURL& url);
+  // Output is passed to |output_sink| as it becomes available.
+  std::unique_ptr<Rewriter> MakeStreamingRewriter(
+      const GURL& url,
+      void (*output_sink)(const char*, size_t, void*),
+      void* output_sink_user_data);
   const std::string& GetContentStylesheet();
 
  private:
-  using GetDATFileDataResult =
-      brave_component_updater::LoadDATFileDataResult<speedreader::SpeedReader>;
-
-  void OnLoadDATFileData(GetDATFileDataResult result);
+  void OnLoadDATFileData(
+      std::unique_ptr<speedreader::SpeedReader> speedreader);
   void OnLoadStylesheet(std::string stylesheet);
 
   std::string content_stylesheet_;
@@ -8,7 +8,6 @@
 #include <utility>
 
 #include "brave/components/speedreader/speedreader_rewriter_service.h"
-#include "brave/components/speedreader/speedreader_url_loader.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/pending_remote.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
@@ -18,8 +17,19 @@ namespace speedreader {
 SpeedReaderThrottle::SpeedReaderThrottle(
     SpeedreaderRewriterService* rewriter_service,
     scoped_refptr<base::SingleThreadTaskRunner> task_runner)
+    : SpeedReaderThrottle(
+          rewriter_service,
+          std::move(task_runner),
+          SpeedReaderURLLoader::GetStreamingRewriterFactory(rewriter_service)) {
+}
+
+SpeedReaderThrottle::SpeedReaderThrottle(
+    SpeedreaderRewriterService* rewriter_service,
+    scoped_refptr<base::SingleThreadTaskRunner> task_runner,
+    SpeedReaderURLLoader::StreamingRewriterFactory streaming_rewriter_factory)
     : rewriter_service_(rewriter_service),
-      task_runner_(std::move(task_runner)) {}
+      task_runner_(std::move(task_runner)),
+      streaming_rewriter_factory_(std::move(streaming_rewriter_factory)) {}
 
 SpeedReaderThrottle::~SpeedReaderThrottle() = default;
 
@@ -37,9 +47,9 @@ void SpeedReaderThrottle::WillProcessResponse(
   mojo::PendingReceiver<network::mojom::URLLoaderClient> source_client_receiver;
   SpeedReaderURLLoader* speedreader_loader;
   std::tie(new_remote, new_receiver, speedreader_loader) =
-      SpeedReaderURLLoader::CreateLoader(weak_factory_.GetWeakPtr(),
-                                         response_url, task_runner_,
-                                         rewriter_service_);
+      SpeedReaderURLLoader::CreateLoader(
+          weak_factory_.GetWeakPtr(), response_url, task_runner_,
+          rewriter_service_, streaming_rewriter_factory_);
   delegate_->InterceptResponse(std::move(new_remote), std::move(new_receiver),
                                &source_loader, &source_client_receiver);
   speedreader_loader->Start(std::move(source_loader),
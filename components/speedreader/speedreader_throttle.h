@@ -7,6 +7,7 @@
 #define BRAVE_COMPONENTS_SPEEDREADER_SPEEDREADER_THROTTLE_H_
 
 #include "base/memory/weak_ptr.h"
+#include "brave/components/speedreader/speedreader_url_loader.h"
 #include "services/network/public/mojom/url_response_head.mojom-forward.h"
 #include "third_party/blink/public/common/loader/url_loader_throttle.h"
 
@@ -27,6 +28,13 @@ class SpeedReaderThrottle : public blink::URLLoaderThrottle {
   // current sequence.
   SpeedReaderThrottle(SpeedreaderRewriterService* rewriter_service,
                       scoped_refptr<base::SingleThreadTaskRunner> task_runner);
+  // Streams pages configured for streaming through the rewriters made by
+  // |streaming_rewriter_factory| instead of the Speedreader rewriter.
+  SpeedReaderThrottle(
+      SpeedreaderRewriterService* rewriter_service,
+      scoped_refptr<base::SingleThreadTaskRunner> task_runner,
+      SpeedReaderURLLoader::StreamingRewriterFactory
+          streaming_rewriter_factory);
   ~SpeedReaderThrottle() override;
 
   SpeedReaderThrottle(const SpeedReaderThrottle&) = delete;
@@ -43,6 +51,7 @@ class SpeedReaderThrottle : public blink::URLLoaderThrottle {
  private:
   SpeedreaderRewriterService* rewriter_service_;  // not owned
   scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
+  SpeedReaderURLLoader::StreamingRewriterFactory streaming_rewriter_factory_;
   base::WeakPtrFactory<SpeedReaderThrottle> weak_factory_{this};
 };
 
@@ -12,6 +12,7 @@
 #include "base/bind.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/task/post_task.h"
+#include "base/task/thread_pool.h"
 #include "brave/components/speedreader/rust/ffi/speedreader.h"
 #include "brave/components/speedreader/speedreader_rewriter_service.h"
 #include "brave/components/speedreader/speedreader_throttle.h"
@@ -23,9 +24,74 @@ namespace speedreader {
 namespace {
 
 constexpr uint32_t kReadBufferSize = 32768;
+// Reading from the source is paused while more rewritten output than this is
+// waiting for the destination.
+constexpr size_t kMaxStreamedOutputSize = 4 * kReadBufferSize;
+
+// A streaming Speedreader rewriter and the output it wrote for the current
+// chunk.
+struct SpeedreaderStreamingRewriter {
+  std::string output;
+  std::unique_ptr<Rewriter> rewriter;
+};
+
+bool RewriteWithSpeedreader(SpeedreaderStreamingRewriter* speedreader,
+                            const std::string& chunk,
+                            bool end,
+                            std::string* output) {
+  int rv = chunk.empty()
+               ? 0
+               : speedreader->rewriter->Write(chunk.data(), chunk.size());
+  if (rv == 0 && end)
+    rv = speedreader->rewriter->End();
+  output->append(speedreader->output);
+  speedreader->output.clear();
+  return rv == 0;
+}
+
+SpeedReaderURLLoader::StreamingRewriteCallback MakeSpeedreaderRewrite(
+    SpeedreaderRewriterService* rewriter_service,
+    const GURL& url) {
+  auto speedreader = std::make_unique<SpeedreaderStreamingRewriter>();
+  speedreader->rewriter = rewriter_service->MakeStreamingRewriter(
+      url,
+      [](const char* chunk, size_t chunk_len, void* user_data) {
+        static_cast<std::string*>(user_data)->append(chunk, chunk_len);
+      },
+      &speedreader->output);
+  return base::BindRepeating(&RewriteWithSpeedreader,
+                             base::Owned(std::move(speedreader)));
+}
 
 }  // namespace
 
+struct SpeedReaderURLLoader::StreamingResult {
+  bool ok;
+  bool ended;
+  std::string output;
+};
+
+struct SpeedReaderURLLoader::StreamingRewriter {
+  // Runs on the streaming sequence. An empty |chunk| with |end| set flushes
+  // the rewriter.
+  StreamingResult Rewrite(std::string chunk, bool end) {
+    SCOPED_UMA_HISTOGRAM_TIMER("Brave.Speedreader.DistillChunk");
+    StreamingResult result{true, end, std::string()};
+    result.ok = rewrite.Run(chunk, end, &result.output);
+    return result;
+  }
+
+  StreamingRewriteCallback rewrite;
+};
+
+// static
+SpeedReaderURLLoader::StreamingRewriterFactory
+SpeedReaderURLLoader::GetStreamingRewriterFactory(
+    SpeedreaderRewriterService* rewriter_service) {
+  return base::BindRepeating(&MakeSpeedreaderRewrite,
+                             base::Unretained(rewriter_service));
+}
+
 // static
 std::tuple<mojo::PendingRemote<network::mojom::URLLoader>,
            mojo::PendingReceiver<network::mojom::URLLoaderClient>,
@@ -34,7 +100,8 @@ SpeedReaderURLLoader::CreateLoader(
     base::WeakPtr<SpeedReaderThrottle> throttle,
     const GURL& response_url,
     scoped_refptr<base::SingleThreadTaskRunner> task_runner,
-    SpeedreaderRewriterService* rewriter_service) {
+    SpeedreaderRewriterService* rewriter_service,
+    StreamingRewriterFactory streaming_rewriter_factory) {
   mojo::PendingRemote<network::mojom::URLLoader> url_loader;
   mojo::PendingRemote<network::mojom::URLLoaderClient> url_loader_client;
   mojo::PendingReceiver<network::mojom::URLLoaderClient>
@@ -43,7 +110,8 @@ SpeedReaderURLLoader::CreateLoader(
 
   auto loader = base::WrapUnique(new SpeedReaderURLLoader(
       std::move(throttle), response_url, std::move(url_loader_client),
-      std::move(task_runner), rewriter_service));
+      std::move(task_runner), rewriter_service,
+      std::move(streaming_rewriter_factory)));
   SpeedReaderURLLoader* loader_rawptr = loader.get();
   mojo::MakeSelfOwnedReceiver(std::move(loader),
                               url_loader.InitWithNewPipeAndPassReceiver());
@@ -57,11 +125,14 @@ SpeedReaderURLLoader::SpeedReaderURLLoader(
     mojo::PendingRemote<network::mojom::URLLoaderClient>
         destination_url_loader_client,
     scoped_refptr<base::SingleThreadTaskRunner> task_runner,
-    SpeedreaderRewriterService* rewriter_service)
+    SpeedreaderRewriterService* rewriter_service,
+    StreamingRewriterFactory streaming_rewriter_factory)
     : throttle_(throttle),
       destination_url_loader_client_(std::move(destination_url_loader_client)),
       response_url_(response_url),
       task_runner_(task_runner),
+      streaming_rewriter_factory_(std::move(streaming_rewriter_factory)),
+      streaming_rewriter_(nullptr, base::OnTaskRunnerDeleter(nullptr)),
       body_consumer_watcher_(FROM_HERE,
                              mojo::SimpleWatcher::ArmingPolicy::MANUAL,
                              task_runner),
@@ -117,7 +188,7 @@ void SpeedReaderURLLoader::OnTransferSizeUpdated(int32_t transfer_size_diff) {
 void SpeedReaderURLLoader::OnStartLoadingResponseBody(
     mojo::ScopedDataPipeConsumerHandle body) {
   VLOG(2) << __func__ << " " << response_url_;
-  state_ = State::kLoading;
+  state_ = MaybeStartStreaming() ? State::kStreaming : State::kLoading;
   body_consumer_handle_ = std::move(body);
   body_consumer_watcher_.Watch(
       body_consumer_handle_.get(),
@@ -143,6 +214,7 @@ void SpeedReaderURLLoader::OnComplete(
       destination_url_loader_client_->OnComplete(status);
       return;
     case State::kLoading:
+    case State::kStreaming:
     case State::kSending:
       // Defer calling OnComplete() until distilling has finished and all
       // data is sent.
@@ -188,6 +260,10 @@ void SpeedReaderURLLoader::ResumeReadingBodyFromNet() {
 }
 
 void SpeedReaderURLLoader::OnBodyReadable(MojoResult) {
+  if (state_ == State::kStreaming) {
+    ReadChunkForStreaming();
+    return;
+  }
   DCHECK_EQ(State::kLoading, state_);
 
   size_t start_size = buffered_body_.size();
@@ -213,15 +289,14 @@ void SpeedReaderURLLoader::OnBodyReadable(MojoResult) {
 
   DCHECK_EQ(MOJO_RESULT_OK, result);
   buffered_body_.resize(start_size + read_bytes);
-  // TODO(iefremov): We actually can partially |pumpContent| to speedreader,
-  // but skipping it for now to simplify things. Pumping is not free in terms
-  // of CPU ticks, so we will have to keep alive speedreader instance on another
-  // thread.
-
   body_consumer_watcher_.ArmOrNotify();
 }
 
 void SpeedReaderURLLoader::OnBodyWritable(MojoResult r) {
+  if (state_ == State::kStreaming) {
+    SendStreamedOutputToClient();
+    return;
+  }
   DCHECK_EQ(State::kSending, state_);
   if (bytes_remaining_in_buffer_ > 0) {
     SendReceivedBodyToClient();
@@ -240,7 +315,7 @@ void SpeedReaderURLLoader::MaybeLaunchSpeedreader() {
   VLOG(2) << __func__ << " buffered body size = " << buffered_body_.size();
   bytes_remaining_in_buffer_ = buffered_body_.size();
 
-  if (bytes_remaining_in_buffer_ > 0) {
+  if (distill_ && bytes_remaining_in_buffer_ > 0) {
     // Offload heavy distilling to another thread.
     base::PostTaskAndReplyWithResult(
         FROM_HERE, {base::ThreadPool(), base::TaskPriority::USER_BLOCKING},
@@ -276,6 +351,167 @@ void SpeedReaderURLLoader::MaybeLaunchSpeedreader() {
   CompleteLoading(std::move(buffered_body_));
 }
 
+bool SpeedReaderURLLoader::MaybeStartStreaming() {
+  if (!throttle_ || !rewriter_service_ ||
+      !rewriter_service_->SupportsStreaming(response_url_)) {
+    return false;
+  }
+
+  streaming_task_runner_ = base::ThreadPool::CreateSequencedTaskRunner(
+      {base::TaskPriority::USER_BLOCKING});
+  streaming_rewriter_ =
+      std::unique_ptr<StreamingRewriter, base::OnTaskRunnerDeleter>(
+          new StreamingRewriter{streaming_rewriter_factory_.Run(response_url_)},
+          base::OnTaskRunnerDeleter(streaming_task_runner_));
+  return true;
+}
+
+void SpeedReaderURLLoader::ReadChunkForStreaming() {
+  DCHECK_EQ(State::kStreaming, state_);
+  if (chunk_in_flight_ || body_read_)
+    return;
+
+  std::string chunk(kReadBufferSize, '\0');
+  uint32_t read_bytes = kReadBufferSize;
+  MojoResult result = body_consumer_handle_->ReadData(
+      &chunk[0], &read_bytes, MOJO_READ_DATA_FLAG_NONE);
+  switch (result) {
+    case MOJO_RESULT_OK:
+      chunk.resize(read_bytes);
+      // Kept until output starts flowing, in case the rewriter gives up.
+      if (!sending_started_)
+        buffered_body_.append(chunk);
+      break;
+    case MOJO_RESULT_FAILED_PRECONDITION:
+      // Reading is finished.
+      body_read_ = true;
+      chunk.clear();
+      break;
+    case MOJO_RESULT_SHOULD_WAIT:
+      body_consumer_watcher_.ArmOrNotify();
+      return;
+    default:
+      NOTREACHED();
+      return;
+  }
+
+  chunk_in_flight_ = true;
+  // |streaming_rewriter_| is deleted on the same sequence, after this task.
+  base::PostTaskAndReplyWithResult(
+      streaming_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&StreamingRewriter::Rewrite,
+                     base::Unretained(streaming_rewriter_.get()),
+                     std::move(chunk), body_read_),
+      base::BindOnce(&SpeedReaderURLLoader::OnChunkRewritten,
+                     weak_factory_.GetWeakPtr()));
+}
+
+void SpeedReaderURLLoader::OnChunkRewritten(StreamingResult result) {
+  DCHECK_EQ(State::kStreaming, state_);
+  chunk_in_flight_ = false;
+  if (!throttle_) {
+    Abort();
+    return;
+  }
+
+  if (!result.ok) {
+    if (sending_started_) {
+      // Part of the rewritten page is already out, there is nothing sensible
+      // to fall back to.
+      Abort();
+      return;
+    }
+    StopStreaming();
+    return;
+  }
+
+  streamed_output_.append(result.output);
+  if (!sending_started_ && !streamed_output_.empty()) {
+    sending_started_ = true;
+    buffered_body_.clear();
+    buffered_body_.shrink_to_fit();
+    throttle_->Resume();
+    mojo::ScopedDataPipeConsumerHandle body_to_send;
+    if (mojo::CreateDataPipe(nullptr, &body_producer_handle_, &body_to_send) !=
+        MOJO_RESULT_OK) {
+      Abort();
+      return;
+    }
+    body_producer_watcher_.Watch(
+        body_producer_handle_.get(),
+        MOJO_HANDLE_SIGNAL_WRITABLE | MOJO_HANDLE_SIGNAL_PEER_CLOSED,
+        base::BindRepeating(&SpeedReaderURLLoader::OnBodyWritable,
+                            base::Unretained(this)));
+    destination_url_loader_client_->OnStartLoadingResponseBody(
+        std::move(body_to_send));
+    streamed_output_.insert(0, rewriter_service_->GetContentStylesheet());
+  }
+
+  if (result.ended && !sending_started_) {
+    // The rewriter found nothing to output.
+    StopStreaming();
+    return;
+  }
+
+  // Backpressure: the next chunk is read once the destination has taken
+  // enough of the output.
+  read_paused_ = !body_read_;
+  SendStreamedOutputToClient();
+}
+
+void SpeedReaderURLLoader::SendStreamedOutputToClient() {
+  DCHECK_EQ(State::kStreaming, state_);
+  if (!streamed_output_.empty()) {
+    uint32_t bytes_sent = streamed_output_.size();
+    MojoResult result = body_producer_handle_->WriteData(
+        streamed_output_.data(), &bytes_sent, MOJO_WRITE_DATA_FLAG_NONE);
+    switch (result) {
+      case MOJO_RESULT_OK:
+        streamed_output_.erase(0, bytes_sent);
+        break;
+      case MOJO_RESULT_FAILED_PRECONDITION:
+        // The pipe is closed unexpectedly. |this| should be deleted once
+        // URLLoaderPtr on the destination is released.
+        Abort();
+        return;
+      case MOJO_RESULT_SHOULD_WAIT:
+        break;
+      default:
+        NOTREACHED();
+        return;
+    }
+  }
+
+  if (!streamed_output_.empty())
+    body_producer_watcher_.ArmOrNotify();
+
+  if (!body_read_) {
+    if (read_paused_ && streamed_output_.size() < kMaxStreamedOutputSize) {
+      read_paused_ = false;
+      body_consumer_watcher_.ArmOrNotify();
+    }
+    return;
+  }
+
+  if (!chunk_in_flight_ && streamed_output_.empty()) {
+    state_ = State::kSending;
+    CompleteSending();
+  }
+}
+
+void SpeedReaderURLLoader::StopStreaming() {
+  DCHECK(!sending_started_);
+  VLOG(2) << __func__ << " " << response_url_;
+  streaming_rewriter_.reset();
+  state_ = State::kLoading;
+  distill_ = false;
+  if (body_read_) {
+    MaybeLaunchSpeedreader();
+    return;
+  }
+  body_consumer_watcher_.ArmOrNotify();
+}
+
 void SpeedReaderURLLoader::CompleteLoading(std::string body) {
   DCHECK_EQ(State::kLoading, state_);
   state_ = State::kSending;
@@ -13,6 +13,7 @@
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
 #include "base/strings/string_piece.h"
 #include "mojo/public/cpp/bindings/binding.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
@@ -26,13 +27,14 @@
 
 namespace speedreader {
 
+class Rewriter;
 class SpeedReaderThrottle;
 class SpeedreaderRewriterService;
 
 // Loads the whole response body and tries to Speedreader-distill it.
 // Cargoculted from |`SniffingURLLoader|.
 //
-// This loader has five states:
+// This loader has six states:
 // kWaitForBody: The initial state until the body is received (=
 //               OnStartLoadingResponseBody() is called) or the response is
 //               finished (= OnComplete() is called). When body is provided, the
@@ -44,6 +46,13 @@ class SpeedreaderRewriterService;
 //            done, this loader will dispatch queued messages like
 //            OnStartLoadingResponseBody() to the destination
 //            loader client, and then the state is changed to kSending.
+// kStreaming: Used instead of kLoading when the page is configured for the
+//             streaming rewriter. Chunks are rewritten as they arrive and the
+//             output is sent to the destination as soon as there is some.
+//             Reading from the source stops while a chunk is being rewritten
+//             or too much output is waiting for the destination. Once the
+//             rewriter has seen the whole body the state is changed to
+//             kSending.
 // kSending: Receives the body and sends it to the destination loader client.
 //           The state changes to kCompleted after all data is sent.
 // kCompleted: All data has been sent to the destination loader.
@@ -58,6 +67,20 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   SpeedReaderURLLoader(const SpeedReaderURLLoader&) = delete;
   SpeedReaderURLLoader& operator=(const SpeedReaderURLLoader&) = delete;
 
+  // Called on the streaming sequence with each chunk of the body, and with an
+  // empty |chunk| and |end| set once the whole body has been read. Appends the
+  // rewritten output to |output| and returns false on error.
+  using StreamingRewriteCallback = base::RepeatingCallback<
+      bool(const std::string& chunk, bool end, std::string* output)>;
+  // Makes the rewriter a page at |url| is streamed through. Called on the
+  // loader's sequence.
+  using StreamingRewriterFactory =
+      base::RepeatingCallback<StreamingRewriteCallback(const GURL& url)>;
+
+  // Streams pages through the Speedreader rewriter made by |rewriter_service|.
+  static StreamingRewriterFactory GetStreamingRewriterFactory(
+      SpeedreaderRewriterService* rewriter_service);
+
   // Start waiting for the body.
   void Start(
       mojo::PendingRemote<network::mojom::URLLoader> source_url_loader_remote,
@@ -72,7 +95,8 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   CreateLoader(base::WeakPtr<SpeedReaderThrottle> throttle,
                const GURL& response_url,
                scoped_refptr<base::SingleThreadTaskRunner> task_runner,
-               SpeedreaderRewriterService* rewriter_service);
+               SpeedreaderRewriterService* rewriter_service,
+               StreamingRewriterFactory streaming_rewriter_factory);
 
  private:
   SpeedReaderURLLoader(base::WeakPtr<SpeedReaderThrottle> throttle,
@@ -80,7 +104,8 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
                        mojo::PendingRemote<network::mojom::URLLoaderClient>
                            destination_url_loader_client,
                        scoped_refptr<base::SingleThreadTaskRunner> task_runner,
-                       SpeedreaderRewriterService* rewriter_service);
+                       SpeedreaderRewriterService* rewriter_service,
+                       StreamingRewriterFactory streaming_rewriter_factory);
 
   // network::mojom::URLLoaderClient implementation (called from the source of
   // the response):
@@ -114,6 +139,17 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   void OnBodyWritable(MojoResult);
   void MaybeLaunchSpeedreader();
 
+  // kStreaming helpers.
+  struct StreamingRewriter;
+  struct StreamingResult;
+  bool MaybeStartStreaming();
+  void ReadChunkForStreaming();
+  void OnChunkRewritten(StreamingResult result);
+  void SendStreamedOutputToClient();
+  // Called if the rewriter fails before any output was sent. Falls back to
+  // passing the original body through.
+  void StopStreaming();
+
   // Gets either distilled or untouched body.
   void CompleteLoading(std::string body);
   void CompleteSending();
@@ -132,7 +168,14 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
 
   scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
 
-  enum class State { kWaitForBody, kLoading, kSending, kCompleted, kAborted };
+  enum class State {
+    kWaitForBody,
+    kLoading,
+    kStreaming,
+    kSending,
+    kCompleted,
+    kAborted
+  };
   State state_ = State::kWaitForBody;
 
   // Set if OnComplete() is called during distilling.
@@ -141,6 +184,20 @@ class SpeedReaderURLLoader : public network::mojom::URLLoaderClient,
   // Note that this could be replaced by a distilled version.
   std::string buffered_body_;
   size_t bytes_remaining_in_buffer_;
+  // Cleared if the page turned out not to be distillable.
+  bool distill_ = true;
+
+  StreamingRewriterFactory streaming_rewriter_factory_;
+  // kStreaming only. The rewriter lives on |streaming_task_runner_|.
+  scoped_refptr<base::SequencedTaskRunner> streaming_task_runner_;
+  std::unique_ptr<StreamingRewriter, base::OnTaskRunnerDeleter>
+      streaming_rewriter_;
+  std::string streamed_output_;
+  bool chunk_in_flight_ = false;
+  // Set while reading waits for the destination to drain |streamed_output_|.
+  bool read_paused_ = false;
+  bool body_read_ = false;
+  bool sending_started_ = false;
 
   mojo::ScopedDataPipeConsumerHandle body_consumer_handle_;
   mojo::ScopedDataPipeProducerHandle body_producer_handle_;
@@ -0,0 +1,376 @@
+/* Copyright (c) 2020 The Brave Authors. All rights reserved.
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/speedreader/speedreader_url_loader.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/optional.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "brave/components/brave_component_updater/browser/test_brave_component_delegate.h"
+#include "brave/components/speedreader/speedreader_rewriter_service.h"
+#include "brave/components/speedreader/speedreader_throttle.h"
+#include "mojo/public/cpp/bindings/pending_receiver.h"
+#include "mojo/public/cpp/bindings/pending_remote.h"
+#include "mojo/public/cpp/bindings/receiver.h"
+#include "mojo/public/cpp/bindings/remote.h"
+#include "mojo/public/cpp/system/data_pipe.h"
+#include "net/base/net_errors.h"
+#include "services/network/public/cpp/url_loader_completion_status.h"
+#include "services/network/public/mojom/url_loader.mojom.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/blink/public/common/loader/url_loader_throttle.h"
+#include "url/gurl.h"
+
+namespace speedreader {
+
+namespace {
+
+constexpr char kTestConfig[] = R"(
+[
+    {
+        "domain": "example.com",
+        "url_rules": [
+            "||example.com/*/article/"
+        ],
+        "declarative_rewrite": {
+            "main_content": [
+                ".article-body"
+            ],
+            "main_content_cleanup": [],
+            "delazify": true,
+            "fix_embeds": false,
+            "content_script": null,
+            "preprocess": []
+        }
+    }
+]
+)";
+
+constexpr char kStreamingURL[] = "https://example.com/news/article/index.html";
+
+// Large enough to be read in several chunks.
+constexpr size_t kBodySize = 100 * 1024;
+// Large enough for the rewritten output to fill the destination pipe.
+constexpr size_t kLargeBodySize = 4 * 1024 * 1024;
+
+constexpr char kEndOfRewrittenBody[] = "</rewritten>";
+
+bool CopyRewrite(std::atomic<size_t>* rewritten_bytes,
+                 const std::string& chunk,
+                 bool end,
+                 std::string* output) {
+  *rewritten_bytes += chunk.size();
+  output->append(chunk);
+  if (end)
+    output->append(kEndOfRewrittenBody);
+  return true;
+}
+
+bool FailingRewrite(const std::string& chunk, bool end, std::string* output) {
+  return false;
+}
+
+bool EmptyRewrite(const std::string& chunk, bool end, std::string* output) {
+  return true;
+}
+
+// Outputs the first chunk, then fails.
+bool FailingAfterFirstChunkRewrite(std::atomic<int>* calls,
+                                   const std::string& chunk,
+                                   bool end,
+                                   std::string* output) {
+  if ((*calls)++ > 0)
+    return false;
+  output->append(chunk);
+  return true;
+}
+
+class TestURLLoaderClient : public network::mojom::URLLoaderClient {
+ public:
+  TestURLLoaderClient() = default;
+  ~TestURLLoaderClient() override = default;
+
+  void Bind(mojo::PendingReceiver<network::mojom::URLLoaderClient> receiver) {
+    receiver_.Bind(std::move(receiver));
+    receiver_.set_disconnect_handler(base::BindOnce(
+        &TestURLLoaderClient::OnDisconnect, base::Unretained(this)));
+  }
+
+  // network::mojom::URLLoaderClient implementation
+  void OnReceiveResponse(
+      network::mojom::URLResponseHeadPtr response_head) override {}
+  void OnReceiveRedirect(
+      const net::RedirectInfo& redirect_info,
+      network::mojom::URLResponseHeadPtr response_head) override {}
+  void OnUploadProgress(int64_t current_position,
+                        int64_t total_size,
+                        OnUploadProgressCallback ack_callback) override {
+    std::move(ack_callback).Run();
+  }
+  void OnReceiveCachedMetadata(mojo_base::BigBuffer data) override {}
+  void OnTransferSizeUpdated(int32_t transfer_size_diff) override {}
+  void OnStartLoadingResponseBody(
+      mojo::ScopedDataPipeConsumerHandle body) override {
+    body_ = std::move(body);
+  }
+  void OnComplete(const network::URLLoaderCompletionStatus& status) override {
+    completion_status_ = status;
+  }
+
+  mojo::ScopedDataPipeConsumerHandle& body() { return body_; }
+  const base::Optional<network::URLLoaderCompletionStatus>& completion_status()
+      const {
+    return completion_status_;
+  }
+  bool disconnected() const { return disconnected_; }
+
+ private:
+  void OnDisconnect() { disconnected_ = true; }
+
+  mojo::Receiver<network::mojom::URLLoaderClient> receiver_{this};
+  mojo::ScopedDataPipeConsumerHandle body_;
+  base::Optional<network::URLLoaderCompletionStatus> completion_status_;
+  bool disconnected_ = false;
+};
+
+// Takes the place of the throttled request: feeds the SpeedReaderURLLoader as
+// its source and hands its output to |client_| as its destination.
+class TestThrottleDelegate : public blink::URLLoaderThrottle::Delegate {
+ public:
+  TestThrottleDelegate() = default;
+  ~TestThrottleDelegate() override = default;
+
+  // blink::URLLoaderThrottle::Delegate implementation
+  void CancelWithError(int error_code,
+                       base::StringPiece custom_reason) override {
+    ADD_FAILURE() << "Unexpected cancellation: " << error_code;
+  }
+  void Resume() override { ++resume_count_; }
+  void InterceptResponse(
+      mojo::PendingRemote<network::mojom::URLLoader> new_loader,
+      mojo::PendingReceiver<network::mojom::URLLoaderClient>
+          new_client_receiver,
+      mojo::PendingRemote<network::mojom::URLLoader>* original_loader,
+      mojo::PendingReceiver<network::mojom::URLLoaderClient>*
+          original_client_receiver) override {
+    destination_loader_.Bind(std::move(new_loader));
+    client_.Bind(std::move(new_client_receiver));
+    source_loader_receiver_ = original_loader->InitWithNewPipeAndPassReceiver();
+    *original_client_receiver = source_client_.BindNewPipeAndPassReceiver();
+  }
+
+  int resume_count() const { return resume_count_; }
+  mojo::Remote<network::mojom::URLLoader>& destination_loader() {
+    return destination_loader_;
+  }
+  TestURLLoaderClient& client() { return client_; }
+  mojo::Remote<network::mojom::URLLoaderClient>& source_client() {
+    return source_client_;
+  }
+
+ private:
+  int resume_count_ = 0;
+  mojo::Remote<network::mojom::URLLoader> destination_loader_;
+  TestURLLoaderClient client_;
+  mojo::PendingReceiver<network::mojom::URLLoader> source_loader_receiver_;
+  mojo::Remote<network::mojom::URLLoaderClient> source_client_;
+};
+
+}  // namespace
+
+class SpeedReaderURLLoaderTest : public testing::Test {
+ public:
+  SpeedReaderURLLoaderTest() = default;
+  ~SpeedReaderURLLoaderTest() override = default;
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    const base::FilePath whitelist_path =
+        temp_dir_.GetPath().AppendASCII("speedreader-updater.dat");
+    ASSERT_EQ(static_cast<int>(strlen(kTestConfig)),
+              base::WriteFile(whitelist_path, kTestConfig,
+                              strlen(kTestConfig)));
+
+    rewriter_service_ =
+        std::make_unique<SpeedreaderRewriterService>(&component_delegate_);
+    rewriter_service_->OnWhitelistReady(whitelist_path);
+    task_environment_.RunUntilIdle();
+    ASSERT_TRUE(rewriter_service_->SupportsStreaming(GURL(kStreamingURL)));
+  }
+
+ protected:
+  // Throttles a response for |kStreamingURL|, streaming it through |rewrite|,
+  // and sends |body| as its whole body.
+  void StartLoading(const std::string& body,
+                    SpeedReaderURLLoader::StreamingRewriteCallback rewrite) {
+    throttle_ = std::make_unique<SpeedReaderThrottle>(
+        rewriter_service_.get(), base::ThreadTaskRunnerHandle::Get(),
+        base::BindRepeating(
+            [](const SpeedReaderURLLoader::StreamingRewriteCallback& rewrite,
+               const GURL& url) { return rewrite; },
+            std::move(rewrite)));
+    throttle_->set_delegate(&delegate_);
+    auto response_head = network::mojom::URLResponseHead::New();
+    bool defer = false;
+    throttle_->WillProcessResponse(GURL(kStreamingURL), response_head.get(),
+                                   &defer);
+    EXPECT_TRUE(defer);
+
+    const MojoCreateDataPipeOptions options = {
+        sizeof(MojoCreateDataPipeOptions), MOJO_CREATE_DATA_PIPE_FLAG_NONE, 1,
+        static_cast<uint32_t>(body.size())};
+    mojo::ScopedDataPipeProducerHandle producer;
+    mojo::ScopedDataPipeConsumerHandle consumer;
+    ASSERT_EQ(MOJO_RESULT_OK,
+              mojo::CreateDataPipe(&options, &producer, &consumer));
+    uint32_t body_size = body.size();
+    ASSERT_EQ(MOJO_RESULT_OK,
+              producer->WriteData(body.data(), &body_size,
+                                  MOJO_WRITE_DATA_FLAG_ALL_OR_NONE));
+    producer.reset();
+
+    delegate_.source_client()->OnStartLoadingResponseBody(std::move(consumer));
+    delegate_.source_client()->OnComplete(
+        network::URLLoaderCompletionStatus(net::OK));
+  }
+
+  // Reads the destination body until the loader closes it.
+  std::string ReadBody() {
+    std::string body;
+    while (true) {
+      task_environment_.RunUntilIdle();
+      if (!client().body().is_valid()) {
+        ADD_FAILURE() << "No body was sent";
+        return body;
+      }
+      char buffer[16 * 1024];
+      uint32_t read_bytes = sizeof(buffer);
+      MojoResult result = client().body()->ReadData(buffer, &read_bytes,
+                                                    MOJO_READ_DATA_FLAG_NONE);
+      if (result == MOJO_RESULT_FAILED_PRECONDITION)
+        return body;
+      if (result == MOJO_RESULT_OK)
+        body.append(buffer, read_bytes);
+    }
+  }
+
+  TestURLLoaderClient& client() { return delegate_.client(); }
+
+  const std::string& stylesheet() {
+    return rewriter_service_->GetContentStylesheet();
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  brave_component_updater::TestBraveComponentDelegate component_delegate_;
+  std::unique_ptr<SpeedreaderRewriterService> rewriter_service_;
+  TestThrottleDelegate delegate_;
+  std::unique_ptr<SpeedReaderThrottle> throttle_;
+};
+
+TEST_F(SpeedReaderURLLoaderTest, StreamsRewrittenBody) {
+  std::atomic<size_t> rewritten_bytes(0);
+  const std::string body(kBodySize, 'a');
+
+  StartLoading(body, base::BindRepeating(&CopyRewrite, &rewritten_bytes));
+
+  EXPECT_EQ(stylesheet() + body + kEndOfRewrittenBody, ReadBody());
+  EXPECT_EQ(1, delegate_.resume_count());
+  ASSERT_TRUE(client().completion_status());
+  EXPECT_EQ(net::OK, client().completion_status()->error_code);
+}
+
+TEST_F(SpeedReaderURLLoaderTest, FallsBackToBufferedBodyOnRewriterError) {
+  const std::string body(kBodySize, 'a');
+
+  StartLoading(body, base::BindRepeating(&FailingRewrite));
+
+  // Nothing was sent yet, so the original body goes through untouched.
+  EXPECT_EQ(body, ReadBody());
+  EXPECT_EQ(1, delegate_.resume_count());
+  ASSERT_TRUE(client().completion_status());
+  EXPECT_EQ(net::OK, client().completion_status()->error_code);
+}
+
+TEST_F(SpeedReaderURLLoaderTest, FallsBackToBufferedBodyWithoutOutput) {
+  const std::string body(kBodySize, 'a');
+
+  StartLoading(body, base::BindRepeating(&EmptyRewrite));
+
+  EXPECT_EQ(body, ReadBody());
+  EXPECT_EQ(1, delegate_.resume_count());
+  ASSERT_TRUE(client().completion_status());
+  EXPECT_EQ(net::OK, client().completion_status()->error_code);
+}
+
+TEST_F(SpeedReaderURLLoaderTest, PausesReadingWhileDestinationIsFull) {
+  std::atomic<size_t> rewritten_bytes(0);
+  const std::string body(kLargeBodySize, 'a');
+
+  StartLoading(body, base::BindRepeating(&CopyRewrite, &rewritten_bytes));
+  task_environment_.RunUntilIdle();
+
+  // The destination isn't reading, so the loader stops pulling the source
+  // once the pipe and its own output buffer are full.
+  ASSERT_TRUE(client().body().is_valid());
+  EXPECT_LT(rewritten_bytes.load(), body.size());
+  EXPECT_FALSE(client().completion_status());
+
+  // Reading resumes as the destination drains the pipe.
+  EXPECT_EQ(stylesheet() + body + kEndOfRewrittenBody, ReadBody());
+  EXPECT_EQ(body.size(), rewritten_bytes.load());
+  ASSERT_TRUE(client().completion_status());
+  EXPECT_EQ(net::OK, client().completion_status()->error_code);
+}
+
+TEST_F(SpeedReaderURLLoaderTest, AbortsOnRewriterErrorAfterOutput) {
+  std::atomic<int> calls(0);
+  const std::string body(kBodySize, 'a');
+
+  StartLoading(body,
+               base::BindRepeating(&FailingAfterFirstChunkRewrite, &calls));
+  task_environment_.RunUntilIdle();
+
+  // Part of the rewritten page is already out, so there is nothing to fall
+  // back to.
+  EXPECT_EQ(1, delegate_.resume_count());
+  EXPECT_TRUE(client().body().is_valid());
+  EXPECT_TRUE(client().disconnected());
+  EXPECT_FALSE(client().completion_status());
+
+  // The loader goes away with the destination.
+  delegate_.destination_loader().reset();
+  task_environment_.RunUntilIdle();
+  EXPECT_FALSE(delegate_.source_client().is_connected());
+}
+
+TEST_F(SpeedReaderURLLoaderTest, AbortsWhenDestinationClosesBody) {
+  std::atomic<size_t> rewritten_bytes(0);
+  const std::string body(kLargeBodySize, 'a');
+
+  StartLoading(body, base::BindRepeating(&CopyRewrite, &rewritten_bytes));
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(client().body().is_valid());
+
+  client().body().reset();
+  task_environment_.RunUntilIdle();
+
+  EXPECT_TRUE(client().disconnected());
+  EXPECT_FALSE(client().completion_status());
+  EXPECT_LT(rewritten_bytes.load(), body.size());
+}
+
+}  // namespace speedreader